@@ -1,39 +1,30 @@
 #include "Application.hpp"
+#include "Benchmark.hpp"
 #include "Utils.hpp"
 
 #include <SDL2/SDL_mixer.h>
 
-#include <thread>
 #include <fstream>
 
 #include <cstdio>
 #include <cassert>
 #include <cstring>
 
-using std::chrono::high_resolution_clock;
-using std::chrono::duration_cast;
-using std::chrono::milliseconds;
-
-static const Char8* c_game_memory_filepath  = "bryte_memory.mem";
-static const Char8* c_record_input_filepath = "bryte_input.in";
-
 Application::Application ( ) :
      m_window                ( nullptr ),
      m_renderer              ( nullptr ),
      m_back_buffer_texture   ( nullptr ),
      m_back_buffer_surface   ( nullptr ),
-     m_previous_update_timestamp ( high_resolution_clock::now ( ) ),
-     m_current_update_timestamp ( m_previous_update_timestamp )
+     m_streaming_back_buffer ( false ),
+     m_present_ticks         ( 0 ),
+     m_max_present_ticks     ( 0 ),
+     m_present_count         ( 0 )
 {
 }
 
 Application::~Application ( )
 {
-     if ( m_game_memory.location ( ) ) {
-          LOG_INFO ( "Freeing allocated game memory.\n" );
-          free ( m_game_memory.location ( ) );
-          m_game_memory.clear ( );
-     }
+     m_simulation.destroy ( );
 
      if ( m_back_buffer_surface ) {
           LOG_INFO ( "Freeing SDL back buffer surface\n" );
@@ -79,7 +70,8 @@ Bool Application::init_sdl ( )
 }
 
 Bool Application::create_window ( const Char8* window_title, Int32 window_width, Int32 window_height,
-                                  Int32 back_buffer_width, Int32 back_buffer_height )
+                                  Int32 back_buffer_width, Int32 back_buffer_height,
+                                  Bool streaming_back_buffer )
 {
 
      // create the window with the specified parameters
@@ -101,6 +93,31 @@ Bool Application::create_window ( const Char8* window_title, Int32 window_width,
           return false;
      }
 
+     if ( streaming_back_buffer ) {
+          LOG_INFO ( "Creating SDL streaming back buffer texture: %d, %d\n", back_buffer_width, back_buffer_height );
+          m_back_buffer_texture = SDL_CreateTexture ( m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                                      back_buffer_width, back_buffer_height );
+
+          if ( m_back_buffer_texture ) {
+               // NOTE: the surface doesn't own any pixels, they are pointed at the locked texture each frame
+               m_back_buffer_surface = SDL_CreateRGBSurfaceFrom ( nullptr, back_buffer_width, back_buffer_height, 32,
+                                                                  back_buffer_width * 4,
+                                                                  0x00FF0000, 0x0000FF00, 0x000000FF, 0 );
+
+               if ( !m_back_buffer_surface ) {
+                    PRINT_SDL_ERROR ( "SDL_CreateRGBSurfaceFrom" );
+                    return false;
+               }
+
+               m_streaming_back_buffer = true;
+
+               return true;
+          }
+
+          PRINT_SDL_ERROR ( "SDL_CreateTexture" );
+          LOG_WARNING ( "Falling back to copying the back buffer surface into a texture\n" );
+     }
+
      // attempt to create a surface to draw on
      LOG_INFO ( "Creating SDL back buffer surface: %d, %d\n", back_buffer_width, back_buffer_height );
      m_back_buffer_surface = SDL_CreateRGBSurface ( 0, back_buffer_width, back_buffer_height, 32,
@@ -123,112 +140,80 @@ Bool Application::create_window ( const Char8* window_title, Int32 window_width,
      return true;
 }
 
-Bool Application::allocate_game_memory ( Uint32 size )
+Bool Application::lock_back_buffer ( )
 {
-     if ( m_game_memory.location ( ) ) {
-          LOG_INFO ( "Freeing allocated game memory.\n" );
-          free ( m_game_memory.location ( ) );
-          m_game_memory.clear ( );
+     if ( !m_streaming_back_buffer ) {
+          return true;
      }
 
-     LOG_INFO ( "Allocating game memory: %d bytes\n", size );
-     Void* memory = malloc ( size );
+     Void* pixels = nullptr;
+     Int32 pitch  = 0;
 
-     if ( !memory ) {
-          LOG_ERROR ( "Allocation of %u bytes failed, malloc() returned NULL.\n", size );
+     if ( SDL_LockTexture ( m_back_buffer_texture, nullptr, &pixels, &pitch ) ) {
+          PRINT_SDL_ERROR ( "SDL_LockTexture" );
           return false;
      }
 
-     m_game_memory = GameMemory ( memory, size );
+     m_back_buffer_surface->pixels = pixels;
+     m_back_buffer_surface->pitch  = pitch;
 
      return true;
 }
 
-Bool Application::save_game_memory ( const Char8* path )
+Void Application::clear_back_buffer ( )
 {
-     LOG_INFO ( "Saving game memory to '%s'\n", path );
-
-     std::ofstream file ( path, std::ios::binary );
-
-     if ( !file.is_open ( ) ) {
-          LOG_ERROR ( "Failed to open '%s' to save game memory.\n", path );
-          return false;
-     }
-
-     file.write ( reinterpret_cast<Char8*>( m_game_memory.location ( ) ), m_game_memory.size ( ) );
-
-     if ( !file ) {
-          LOG_ERROR ( "Failed to write %u bytes to '%s' to save game memory.\n",
-                      m_game_memory.size ( ), path );
-     }
+     //Uint32    clear_color = SDL_MapRGB ( m_back_buffer_surface->format, 86, 156, 214 );
+     Uint32 clear_color = 0;
+     SDL_Rect  clear_rect  { 0, 0, m_back_buffer_surface->w, m_back_buffer_surface->h };
 
-     file.close ( );
-     return true;
+     SDL_FillRect ( m_back_buffer_surface, &clear_rect, clear_color );
 }
 
-Bool Application::load_game_memory ( const Char8* path )
+Void Application::render_to_window ( )
 {
-     LOG_INFO ( "Loading game memory from '%s'\n", path );
-
-     std::ifstream file ( path, std::ios::binary );
-
-     if ( !file.is_open ( ) ) {
-          LOG_ERROR ( "Failed to open '%s' to load game memory.\n", path );
-          return false;
+     Uint64 start = SDL_GetPerformanceCounter ( );
+
+     if ( m_streaming_back_buffer ) {
+          SDL_UnlockTexture ( m_back_buffer_texture );
+          m_back_buffer_surface->pixels = nullptr;
+     } else {
+          SDL_UpdateTexture ( m_back_buffer_texture, nullptr, m_back_buffer_surface->pixels,
+                              m_back_buffer_surface->pitch );
      }
 
-     file.read ( reinterpret_cast<Char8*>( m_game_memory.location ( ) ), m_game_memory.size ( ) );
+     SDL_RenderClear ( m_renderer );
+     SDL_RenderCopy ( m_renderer, m_back_buffer_texture, nullptr, nullptr );
 
-     if ( !file ) {
-          LOG_ERROR ( "Failed to read %u bytes from '%s' to load game memory.\n",
-                      m_game_memory.size ( ), path );
-     }
+     SDL_RenderPresent ( m_renderer );
 
-     file.close ( );
-     return true;
-}
+     Uint64 ticks = SDL_GetPerformanceCounter ( ) - start;
 
-Void Application::handle_input ( )
-{
-     if ( m_input_recorder.is_recording ( ) ) {
-          m_input_recorder.write_frame ( m_game_input );
-     }
+     m_present_ticks += ticks;
+     m_present_count++;
 
-     if ( m_input_recorder.is_playing_back ( ) ) {
-          if ( !m_input_recorder.read_frame ( m_game_input ) ) {
-               load_game_memory ( c_game_memory_filepath );
-          }
+     if ( ticks > m_max_present_ticks ) {
+          m_max_present_ticks = ticks;
      }
-
-     m_game_functions.game_user_input_func ( m_game_memory, m_game_input );
 }
 
-Void Application::clear_back_buffer ( )
+Void Application::log_present_timing ( )
 {
-     //Uint32    clear_color = SDL_MapRGB ( m_back_buffer_surface->format, 86, 156, 214 );
-     Uint32 clear_color = 0;
-     SDL_Rect  clear_rect  { 0, 0, m_back_buffer_surface->w, m_back_buffer_surface->h };
-
-     SDL_FillRect ( m_back_buffer_surface, &clear_rect, clear_color );
-}
-
-Void Application::render_to_window ( )
-{
-     SDL_UpdateTexture ( m_back_buffer_texture, nullptr, m_back_buffer_surface->pixels,
-                         m_back_buffer_surface->pitch );
+     if ( !m_present_count ) {
+          return;
+     }
 
-     SDL_RenderClear ( m_renderer );
-     SDL_RenderCopy ( m_renderer, m_back_buffer_texture, nullptr, nullptr );
+     Real64 ms_per_tick = 1000.0 / static_cast<Real64>( SDL_GetPerformanceFrequency ( ) );
 
-     SDL_RenderPresent ( m_renderer );
+     LOG_INFO ( "Presented %u frames by %s: mean %.3f ms, max %.3f ms\n", m_present_count,
+                m_streaming_back_buffer ? "streaming texture" : "surface copy",
+                ( static_cast<Real64>( m_present_ticks ) / m_present_count ) * ms_per_tick,
+                static_cast<Real64>( m_max_present_ticks ) * ms_per_tick );
 }
 
 Bool Application::poll_sdl_events ( )
 {
      SDL_Event sdl_event = {};
 
-     m_game_input.reset ( );
-
      while ( SDL_PollEvent ( &sdl_event ) ) {
           if ( sdl_event.type == SDL_QUIT ) {
                return false;
@@ -243,35 +228,41 @@ Bool Application::poll_sdl_events ( )
                }
 
                if ( sc == SDL_SCANCODE_0 ) {
-                    m_game_functions.load ( m_settings.shared_library_path );
+                    m_simulation.reload_game_code ( );
                     continue;
                }
 
                if ( sc == SDL_SCANCODE_1 ) {
-                    if ( !m_input_recorder.is_recording ( ) &&
-                         !m_input_recorder.is_playing_back ( ) ) {
-                         m_input_recorder.start_recording ( c_record_input_filepath );
-                         save_game_memory ( c_game_memory_filepath );
+                    if ( m_simulation.start_recording ( ) ) {
                          continue;
                     }
                }
 
                if ( sc == SDL_SCANCODE_2 ) {
-                    if ( m_input_recorder.is_recording ( ) ) {
-                         m_input_recorder.stop_recording ( );
-                         load_game_memory ( c_game_memory_filepath );
-                         m_input_recorder.start_playing_back ( c_record_input_filepath );
+                    if ( m_simulation.start_playing_back ( ) ) {
                          continue;
                     }
                }
 
                if ( sc == SDL_SCANCODE_3 ) {
-                    if ( m_input_recorder.is_playing_back ( ) ) {
-                         m_input_recorder.stop_playing_back ( );
+                    if ( m_simulation.stop_playing_back ( ) ) {
                          continue;
                     }
                }
 
+               if ( sc == SDL_SCANCODE_4 ) {
+                    m_frame_pacer.log_statistics ( );
+                    log_present_timing ( );
+                    m_simulation.snapshot_ring ( ).log_statistics ( );
+                    m_simulation.log_memory_usage ( );
+                    continue;
+               }
+
+               if ( sc == SDL_SCANCODE_5 ) {
+                    m_simulation.rewind ( m_settings.simulation_frames_per_second * c_rewind_seconds );
+                    continue;
+               }
+
                if ( !m_game_input.add_key_change ( sc, true ) ) {
                     LOG_WARNING ( "Unable to handle more than %d keys per frame\n",
                                   GameInput::c_max_key_change_count );
@@ -357,26 +348,16 @@ Bool Application::poll_sdl_events ( )
      return true;
 }
 
-Real32 Application::time_and_limit_loop ( Int32 locked_frames_per_second )
+Real64 Application::time_and_limit_loop ( )
 {
-     m_previous_update_timestamp = m_current_update_timestamp;
-     m_current_update_timestamp  = high_resolution_clock::now ( );
-
-     Auto duration = m_current_update_timestamp - m_previous_update_timestamp;
-     Auto dt_ms = duration_cast<milliseconds>( duration ).count ( );
+     Real64 elapsed = m_frame_pacer.wait_for_next_frame ( );
 
-     Auto max_allowed_milliseconds = 1000 / locked_frames_per_second;
-
-     if ( dt_ms < max_allowed_milliseconds ) {
-          Auto time_until_limit = max_allowed_milliseconds - dt_ms;
-          std::this_thread::sleep_for ( milliseconds ( time_until_limit ) );
-          dt_ms += time_until_limit;
-     } else if ( dt_ms > max_allowed_milliseconds * 2 ) {
-          // log a warning if we take much too long on a frame
-          LOG_WARNING ( "game loop executed in %d milliseconds\n", dt_ms );
+     // log a warning if we take much too long on a frame
+     if ( elapsed * m_settings.render_frames_per_second > 2.0 ) {
+          LOG_WARNING ( "game loop executed in %.2f milliseconds\n", elapsed * 1000.0 );
      }
 
-     return static_cast<float>( dt_ms ) / 1000.0f;
+     return elapsed;
 }
 
 Bool Application::run_game ( const Settings& settings, Void* game_settings )
@@ -388,51 +369,129 @@ Bool Application::run_game ( const Settings& settings, Void* game_settings )
      }
 
      if ( !create_window ( settings.window_title, settings.window_width, settings.window_height,
-                           settings.back_buffer_width, settings.back_buffer_height ) ) {
+                           settings.back_buffer_width, settings.back_buffer_height,
+                           settings.streaming_back_buffer ) ) {
           return false;
      }
 
-     if ( !m_game_functions.load ( settings.shared_library_path ) ) {
+     if ( !m_simulation.load ( settings.shared_library_path, settings.game_memory_allocation_size,
+                               settings.game_memory_warning_threshold, game_settings ) ) {
           return false;
      }
 
-     if ( !allocate_game_memory ( settings.game_memory_allocation_size ) ) {
-          return false;
-     }
+     if ( settings.benchmark_report_path ) {
+          Bool success = run_benchmark ( game_settings );
 
-     Real32 time_delta = 0.0f;
+          m_simulation.destroy ( );
 
-     LOG_INFO ( "Initializing game\n" );
-     if ( !m_game_functions.game_init_func ( m_game_memory, game_settings ) ) {
-          return false;
+          return success;
      }
 
+     Real64 simulation_step  = 1.0 / static_cast<Real64>( settings.simulation_frames_per_second );
+     Real64 accumulated_time = 0.0;
+
      LOG_INFO ( "Starting game loop\n" );
-     m_current_update_timestamp = high_resolution_clock::now ( );
+     m_frame_pacer.start ( settings.render_frames_per_second );
 
      while ( true ) {
 
-          time_delta = time_and_limit_loop ( settings.locked_frames_per_second );
+          accumulated_time += time_and_limit_loop ( );
+
+          // drop time we can't catch up on rather than spiraling after a stall
+          if ( accumulated_time > simulation_step * c_max_simulation_steps_per_frame ) {
+               accumulated_time = simulation_step * c_max_simulation_steps_per_frame;
+          }
 
           if ( !poll_sdl_events ( ) ) {
                break;
           }
 
-          handle_input ( );
+          // NOTE: input collects across rendered frames until a simulation step consumes it, so
+          //       recorded input lines up with simulation steps
+          while ( accumulated_time >= simulation_step ) {
+               m_simulation.update ( m_game_input, static_cast<Real32>( simulation_step ) );
 
-          m_game_functions.game_update_func ( m_game_memory, time_delta );
+               m_game_input.reset ( );
+
+               accumulated_time -= simulation_step;
+          }
+
+          Real32 interpolation = static_cast<Real32>( accumulated_time / simulation_step );
+
+          if ( !lock_back_buffer ( ) ) {
+               break;
+          }
 
           clear_back_buffer ( );
-          m_game_functions.game_render_func ( m_game_memory, m_back_buffer_surface );
+          m_simulation.render ( m_back_buffer_surface, interpolation );
           render_to_window ( );
      }
 
-     LOG_INFO ( "Destroying game\n" );
-     m_game_functions.game_destroy_func ( m_game_memory );
+     m_frame_pacer.log_statistics ( );
+     log_present_timing ( );
+
+     m_simulation.destroy ( );
 
      return 0;
 }
 
+Bool Application::run_benchmark ( Void* game_settings )
+{
+     InputRecorder input_recorder;
+     Benchmark     benchmark;
+
+     m_simulation.set_snapshots_enabled ( false );
+
+     if ( !m_simulation.load_snapshot ( m_settings.benchmark_memory_path, game_settings ) ) {
+          return false;
+     }
+
+     if ( !input_recorder.start_playing_back ( m_settings.benchmark_input_path ) ) {
+          return false;
+     }
+
+     if ( !benchmark.start ( Benchmark::c_default_max_frame_count ) ) {
+          return false;
+     }
+
+     Real32 time_delta = 1.0f / static_cast<Real32>( m_settings.simulation_frames_per_second );
+
+     LOG_INFO ( "Replaying '%s' from '%s'\n", m_settings.benchmark_input_path, m_settings.benchmark_memory_path );
+
+     // NOTE: one simulation step per rendered frame, as fast as we can go
+     while ( !benchmark.full ( ) && input_recorder.read_frame ( m_game_input ) ) {
+          benchmark.begin_stage ( Benchmark::Stage::update );
+          m_simulation.update ( m_game_input, time_delta );
+          benchmark.end_stage ( Benchmark::Stage::update );
+
+          benchmark.begin_stage ( Benchmark::Stage::render );
+
+          if ( !lock_back_buffer ( ) ) {
+               break;
+          }
+
+          clear_back_buffer ( );
+          m_simulation.render ( m_back_buffer_surface, 1.0f );
+          benchmark.end_stage ( Benchmark::Stage::render );
+
+          benchmark.begin_stage ( Benchmark::Stage::present );
+          render_to_window ( );
+          benchmark.end_stage ( Benchmark::Stage::present );
+
+          benchmark.end_frame ( );
+
+          m_game_input.reset ( );
+
+          if ( !poll_sdl_events ( ) ) {
+               break;
+          }
+     }
+
+     input_recorder.stop_playing_back ( );
+
+     return benchmark.write_report ( m_settings.benchmark_report_path, false );
+}
+
 Int32 Application::window_to_back_buffer ( Int32 pos, Int32 dimension, Int32 back_buffer_dimension )
 {
      float pct = static_cast<float>( pos ) / static_cast<float>( dimension );
@@ -1,19 +1,15 @@
 #ifndef APPLICATION_HPP
 #define APPLICATION_HPP
 
-#include "InputRecorder.hpp"
-#include "GameMemory.hpp"
-#include "GameFunction.hpp"
+#include "Simulation.hpp"
+#include "FramePacer.hpp"
 
 #include <SDL2/SDL.h>
 
-#include <chrono>
 #include <fstream>
 
 #define PRINT_SDL_ERROR(sdl_api) LOG_ERROR ( "%s() failed: %s\n", sdl_api, SDL_GetError ( ) );
 
-using std::chrono::high_resolution_clock;
-
 // Create's a platform application to run the game code
 class Application {
 public:
@@ -30,7 +26,21 @@ public:
 
           Uint32       game_memory_allocation_size;
 
-          Uint32       locked_frames_per_second;
+          // percent of an arena that warns when crossed
+          Uint32       game_memory_warning_threshold;
+
+          // the game is simulated at a fixed rate, rendering interpolates between simulation steps
+          Uint32       simulation_frames_per_second;
+          Uint32       render_frames_per_second;
+
+          // render straight into a locked streaming texture instead of copying a surface into it
+          Bool         streaming_back_buffer;
+
+          // when set, replay the recorded input from the memory snapshot unthrottled and write
+          // frame timings to the report path
+          const Char8* benchmark_report_path;
+          const Char8* benchmark_memory_path;
+          const Char8* benchmark_input_path;
      };
 
      Application ( );
@@ -49,28 +59,31 @@ private:
 
      Bool init_sdl ( );
      Bool create_window        ( const Char8* window_title, Int32 window_width, Int32 window_height,
-                                 Int32 back_buffer_width, Int32 back_buffer_height );
-     Bool allocate_game_memory ( Uint32 size );
-
-     Bool save_game_memory      ( const Char8* save_path );
-     Bool load_game_memory      ( const Char8* save_path );
+                                 Int32 back_buffer_width, Int32 back_buffer_height,
+                                 Bool streaming_back_buffer );
 
-     Real32 time_and_limit_loop ( Int32 locked_frames_per_second );
+     Real64 time_and_limit_loop ( );
      Bool   poll_sdl_events     ( );
-     Void   handle_input        ( );
+     Bool   run_benchmark       ( Void* game_settings );
+     Bool   lock_back_buffer    ( );
      Void   clear_back_buffer   ( );
      Void   render_to_window    ( );
 
+     Void   log_present_timing  ( );
+
      Int32 window_to_back_buffer ( Int32 pos, Int32 dimension, Int32 back_buffer_dimension );
      Void translate_window_pos_to_back_buffer ( Int32 sx, Int32 sy, Int32* bx, Int32* by );
 
 private:
 
-     static const Int32  c_func_count = 5;
-     static const Char8* c_game_func_strs [ c_func_count ];
-
      static const Uint32 c_max_key_changes_per_frame = 8;
 
+     // cap on simulation steps run to catch up after a long frame
+     static const Uint32 c_max_simulation_steps_per_frame = 4;
+
+     // how far the rewind key jumps back
+     static const Uint32 c_rewind_seconds = 2;
+
 private:
 
      // SDL components required to make window and draw to it
@@ -80,19 +93,19 @@ private:
      Int32               m_controller_id;
      SDL_Texture*        m_back_buffer_texture;
      SDL_Surface*        m_back_buffer_surface;
+     Bool                m_streaming_back_buffer;
 
+     // time spent getting the back buffer onto the window
+     Uint64              m_present_ticks;
+     Uint64              m_max_present_ticks;
+     Uint32              m_present_count;
 
-     GameFunctions m_game_functions;
-     GameMemory    m_game_memory;
+     Simulation    m_simulation;
      GameInput     m_game_input;
 
-     InputRecorder m_input_recorder;
-
      Settings      m_settings;
 
-     // frame timestamps
-     high_resolution_clock::time_point m_previous_update_timestamp;
-     high_resolution_clock::time_point m_current_update_timestamp;
+     FramePacer    m_frame_pacer;
 };
 
 #endif
@@ -0,0 +1,894 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include <SDL2/SDL.h>
+
+#include "Collision.hpp"
+#include "LightBlend.hpp"
+#include "Map.hpp"
+#include "Interactives.hpp"
+#include "Character.hpp"
+
+using namespace bryte;
+
+struct MicroBenchmark {
+     const Char8* name;
+     Void ( *run ) ( Uint32 iterations );
+};
+
+Void print_help ( )
+{
+     printf ( "Bryte micro benchmarks\n" );
+     printf ( "Usage: ./bryte_bench [ options ] [ benchmark names ]\n" );
+     printf ( "  -n number of iterations, 1000 by default\n" );
+     printf ( "  -l lists the benchmarks\n" );
+     printf ( "  -h displays this helpful information\n\n" );
+}
+
+static Uint32 g_seed = 0x2545F491;
+
+// xorshift so every run tests the same data without pulling in the game's Random
+static Uint32 next_random ( )
+{
+     g_seed ^= g_seed << 13;
+     g_seed ^= g_seed >> 17;
+     g_seed ^= g_seed << 5;
+     return g_seed;
+}
+
+static Real32 random_real ( Real32 min, Real32 max )
+{
+     return min + ( max - min ) * static_cast<Real32>( next_random ( ) % 10000 ) / 10000.0f;
+}
+
+static Real64 ticks_to_ns ( Uint64 ticks )
+{
+     return static_cast<Real64>( ticks ) * 1000000000.0 / static_cast<Real64>( SDL_GetPerformanceFrequency ( ) );
+}
+
+// the corner and center tests rect_collides_with_rect ( ) used before it was a separating axis test
+static Bool corner_rect_collides_with_rect ( Real32 a_left, Real32 a_bottom, Real32 a_width, Real32 a_height,
+                                             Real32 b_left, Real32 b_bottom, Real32 b_width, Real32 b_height )
+{
+     Real32 a_right = a_left + a_width;
+     Real32 a_top = a_bottom + a_height;
+     Real32 b_right = b_left + b_width;
+     Real32 b_top = b_bottom + b_height;
+
+     return point_inside_rect ( a_left, a_bottom, b_left, b_bottom, b_right, b_top ) ||
+            point_inside_rect ( a_right, a_bottom, b_left, b_bottom, b_right, b_top ) ||
+            point_inside_rect ( a_left, a_top, b_left, b_bottom, b_right, b_top ) ||
+            point_inside_rect ( a_right, a_top, b_left, b_bottom, b_right, b_top ) ||
+            point_inside_rect ( a_left + a_width * 0.5f, a_bottom + a_height * 0.5f,
+                                b_left, b_bottom, b_right, b_top ) ||
+            point_inside_rect ( b_left, b_bottom, a_left, a_bottom, a_right, a_top ) ||
+            point_inside_rect ( b_right, b_bottom, a_left, a_bottom, a_right, a_top ) ||
+            point_inside_rect ( b_left, b_top, a_left, a_bottom, a_right, a_top ) ||
+            point_inside_rect ( b_right, b_top, a_left, a_bottom, a_right, a_top );
+}
+
+static Void bench_collision ( Uint32 iterations )
+{
+     // a map's worth of character sized rects, the test rect is an attack or a projectile point
+     static const Uint32 c_rect_count = 256;
+     static const Uint32 c_query_count = 64;
+
+     static CollisionBatch<c_rect_count> batch;
+     static Bool hits [ c_rect_count ];
+     static Bool expected [ c_rect_count ];
+     Real32 queries [ c_query_count ][ 4 ];
+
+     batch.clear ( );
+
+     for ( Uint32 i = 0; i < c_rect_count; ++i ) {
+          batch.add ( random_real ( 0.0f, 40.0f ), random_real ( 0.0f, 30.0f ),
+                      random_real ( 0.5f, 2.0f ), random_real ( 0.5f, 2.0f ) );
+     }
+
+     for ( Uint32 q = 0; q < c_query_count; ++q ) {
+          queries [ q ][ 0 ] = random_real ( 0.0f, 40.0f );
+          queries [ q ][ 1 ] = random_real ( 0.0f, 30.0f );
+          queries [ q ][ 2 ] = random_real ( 0.0f, 1.4f );
+          queries [ q ][ 3 ] = random_real ( 0.0f, 1.4f );
+     }
+
+     Uint64 tests = static_cast<Uint64>( iterations ) * c_query_count * c_rect_count;
+     Uint32 total_hits = 0;
+     Uint32 corner_misses = 0;
+
+     // the old corner test, one pair at a time
+     Uint64 start = SDL_GetPerformanceCounter ( );
+
+     for ( Uint32 it = 0; it < iterations; ++it ) {
+          for ( Uint32 q = 0; q < c_query_count; ++q ) {
+               for ( Uint32 i = 0; i < c_rect_count; ++i ) {
+                    total_hits += corner_rect_collides_with_rect ( queries [ q ][ 0 ], queries [ q ][ 1 ],
+                                                                   queries [ q ][ 2 ], queries [ q ][ 3 ],
+                                                                   batch.lefts [ i ], batch.bottoms [ i ],
+                                                                   batch.rights [ i ] - batch.lefts [ i ],
+                                                                   batch.tops [ i ] - batch.bottoms [ i ] );
+               }
+          }
+     }
+
+     Uint64 corner_ticks = SDL_GetPerformanceCounter ( ) - start;
+
+     // separating axis test, one pair at a time
+     start = SDL_GetPerformanceCounter ( );
+
+     for ( Uint32 it = 0; it < iterations; ++it ) {
+          for ( Uint32 q = 0; q < c_query_count; ++q ) {
+               for ( Uint32 i = 0; i < c_rect_count; ++i ) {
+                    total_hits += rect_collides_with_rect ( queries [ q ][ 0 ], queries [ q ][ 1 ],
+                                                            queries [ q ][ 2 ], queries [ q ][ 3 ],
+                                                            batch.lefts [ i ], batch.bottoms [ i ],
+                                                            batch.rights [ i ] - batch.lefts [ i ],
+                                                            batch.tops [ i ] - batch.bottoms [ i ] );
+               }
+          }
+     }
+
+     Uint64 pair_ticks = SDL_GetPerformanceCounter ( ) - start;
+
+     printf ( "collision: %llu rect tests per run\n", static_cast<unsigned long long>( tests ) );
+     printf ( "  %-16s %8.3f ns/test\n", "corner pairs", ticks_to_ns ( corner_ticks ) / tests );
+     printf ( "  %-16s %8.3f ns/test %6.2fx\n", "axis pairs", ticks_to_ns ( pair_ticks ) / tests,
+              static_cast<Real64>( corner_ticks ) / static_cast<Real64>( pair_ticks ) );
+
+     CollisionKernel selected = collision_kernel ( );
+
+     for ( Int32 k = CollisionKernel::scalar; k < CollisionKernel::kernel_count; ++k ) {
+          Auto kernel = static_cast<CollisionKernel>( k );
+
+          if ( !set_collision_kernel ( kernel ) ) {
+               continue;
+          }
+
+          // check the batch against the pair test before timing it
+          Uint32 mismatches = 0;
+
+          for ( Uint32 q = 0; q < c_query_count; ++q ) {
+               batch.test ( queries [ q ][ 0 ], queries [ q ][ 1 ], queries [ q ][ 2 ], queries [ q ][ 3 ], hits );
+
+               for ( Uint32 i = 0; i < c_rect_count; ++i ) {
+                    expected [ i ] = rect_collides_with_rect ( queries [ q ][ 0 ], queries [ q ][ 1 ],
+                                                               queries [ q ][ 2 ], queries [ q ][ 3 ],
+                                                               batch.lefts [ i ], batch.bottoms [ i ],
+                                                               batch.rights [ i ] - batch.lefts [ i ],
+                                                               batch.tops [ i ] - batch.bottoms [ i ] );
+                    mismatches += hits [ i ] != expected [ i ];
+
+                    if ( k == CollisionKernel::scalar ) {
+                         corner_misses += expected [ i ] &&
+                                          !corner_rect_collides_with_rect ( queries [ q ][ 0 ], queries [ q ][ 1 ],
+                                                                            queries [ q ][ 2 ], queries [ q ][ 3 ],
+                                                                            batch.lefts [ i ], batch.bottoms [ i ],
+                                                                            batch.rights [ i ] - batch.lefts [ i ],
+                                                                            batch.tops [ i ] - batch.bottoms [ i ] );
+                    }
+               }
+          }
+
+          start = SDL_GetPerformanceCounter ( );
+
+          for ( Uint32 it = 0; it < iterations; ++it ) {
+               for ( Uint32 q = 0; q < c_query_count; ++q ) {
+                    total_hits += batch.test ( queries [ q ][ 0 ], queries [ q ][ 1 ],
+                                               queries [ q ][ 2 ], queries [ q ][ 3 ], hits );
+               }
+          }
+
+          Uint64 batch_ticks = SDL_GetPerformanceCounter ( ) - start;
+
+          printf ( "  %-16s %8.3f ns/test %6.2fx %s\n", collision_kernel_name ( kernel ),
+                   ticks_to_ns ( batch_ticks ) / tests,
+                   static_cast<Real64>( corner_ticks ) / static_cast<Real64>( batch_ticks ),
+                   mismatches ? "MISMATCH" : "" );
+
+          if ( mismatches ) {
+               printf ( "  %s batch disagreed with the pair test %u times\n", collision_kernel_name ( kernel ),
+                        mismatches );
+          }
+     }
+
+     set_collision_kernel ( selected );
+
+     // overlaps where neither rect has a corner inside the other, the old test missed these
+     printf ( "  %u crossing overlaps the corner test missed, %u hits total\n", corner_misses, total_hits );
+}
+
+enum WallLayout {
+     scattered,
+     corridors,
+     layout_count
+};
+
+static const Char8* c_wall_layout_names [ layout_count ] = {
+     "scattered",
+     "corridors"
+};
+
+// the largest map there is room for, solid enough that every character is next to a wall
+static Void build_wall_map ( Map& map, Interactives& interactives, WallLayout layout )
+{
+     static const Uint8 c_width = 32;
+     static const Uint8 c_height = 32;
+
+     map.initialize ( c_width, c_height );
+     interactives.reset ( c_width, c_height );
+
+     for ( Location tile; tile.y < c_height; ++tile.y ) {
+          for ( tile.x = 0; tile.x < c_width; ++tile.x ) {
+               Bool solid = false;
+
+               switch ( layout ) {
+               default:
+                    break;
+               case WallLayout::scattered:
+                    solid = ( next_random ( ) % 100 ) < 40;
+                    break;
+               case WallLayout::corridors:
+                    // walls every third row and column with a gap somewhere along each
+                    solid = ( ( tile.y % 3 ) == 0 || ( tile.x % 3 ) == 0 ) && ( next_random ( ) % 100 ) < 85;
+                    break;
+               }
+
+               map.set_tile_location_solid ( tile, solid );
+          }
+     }
+}
+
+static Void spawn_wall_characters ( Character* characters, Uint32 count, const Map& map )
+{
+     for ( Uint32 i = 0; i < count; ++i ) {
+          Auto& character = characters [ i ];
+          Location tile;
+
+          do {
+               tile.x = next_random ( ) % map.width ( );
+               tile.y = next_random ( ) % map.height ( );
+          } while ( map.get_tile_location_solid ( tile ) );
+
+          character = Character ( );
+
+          character.life_state = Entity::LifeState::alive;
+          character.state = Character::State::idle;
+          character.facing = Direction::left;
+          character.position = Map::location_to_vector ( tile );
+          character.dimension.set ( pixels_to_meters ( 16 ), pixels_to_meters ( 16 ) );
+          character.collision_offset.set ( pixels_to_meters ( 1 ), pixels_to_meters ( 4 ) );
+          character.collision_dimension.set ( pixels_to_meters ( 12 ), pixels_to_meters ( 10 ) );
+          character.walk_acceleration = 9.0f;
+          character.deceleration_scale = 5.0f;
+          character.walk_frame_count = 3;
+          character.walk_frame_change = 1;
+          character.walk_frame_rate = 1.0f;
+          character.collided_last_frame = Direction::count;
+          character.damage_pushed = Direction::count;
+          character.on_moving_walkway = Direction::count;
+          character.effected_by_element = Element::none;
+     }
+}
+
+// every character wanders, picking a new direction now and then
+static Void walk_wall_characters ( Character* characters, Uint32 count, const Map& map,
+                                   Interactives& interactives, Bool merged_walls, Uint32 frames )
+{
+     static const Real32 c_frame_time = 1.0f / 60.0f;
+
+     for ( Uint32 f = 0; f < frames; ++f ) {
+          for ( Uint32 i = 0; i < count; ++i ) {
+               Auto& character = characters [ i ];
+
+               if ( ( f % 30 ) == 0 ) {
+                    character.facing = static_cast<Direction>( next_random ( ) % Direction::count );
+               }
+
+               character.walk ( character.facing );
+
+               // half of them walk diagonally and slide along the walls they hit
+               if ( i % 2 ) {
+                    character.walk ( static_cast<Direction>( ( character.facing + 1 ) % Direction::count ) );
+               }
+
+               character.update ( c_frame_time, map, interactives, merged_walls );
+          }
+     }
+}
+
+static Void bench_walls ( Uint32 iterations )
+{
+     static const Uint32 c_character_count = 32;
+     static const Uint32 c_frames_per_iteration = 60;
+
+     // the game never constructs a map, it lives in zeroed game memory
+     static Uint64 map_memory [ ( sizeof ( Map ) + sizeof ( Uint64 ) - 1 ) / sizeof ( Uint64 ) ];
+     static Interactives interactives;
+     static Character characters [ c_character_count ];
+     static Vector merged_positions [ c_character_count ];
+
+     Auto& map = *reinterpret_cast<Map*>( map_memory );
+
+     printf ( "walls: %u characters for %u frames per run\n", c_character_count,
+              iterations * c_frames_per_iteration );
+
+     for ( Int32 l = 0; l < WallLayout::layout_count; ++l ) {
+          Auto layout = static_cast<WallLayout>( l );
+          Uint64 ticks [ 2 ];
+
+          // run both with the same seed so the characters make the same choices
+          for ( Int32 run = 0; run < 2; ++run ) {
+               g_seed = 0x2545F491 + l;
+
+               build_wall_map ( map, interactives, layout );
+               spawn_wall_characters ( characters, c_character_count, map );
+
+               Uint64 start = SDL_GetPerformanceCounter ( );
+
+               walk_wall_characters ( characters, c_character_count, map, interactives, run == 0,
+                                      iterations * c_frames_per_iteration );
+
+               ticks [ run ] = SDL_GetPerformanceCounter ( ) - start;
+
+               for ( Uint32 i = 0; i < c_character_count && run == 0; ++i ) {
+                    merged_positions [ i ] = characters [ i ].position;
+               }
+          }
+
+          Uint32 solid_count = 0;
+
+          for ( Location tile; tile.y < map.height ( ); ++tile.y ) {
+               for ( tile.x = 0; tile.x < map.width ( ); ++tile.x ) {
+                    solid_count += map.get_tile_location_solid ( tile );
+               }
+          }
+
+          // per tile collision can catch on the seams between solid tiles, merged walls don't have any
+          Uint32 diverged = 0;
+
+          for ( Uint32 i = 0; i < c_character_count; ++i ) {
+               diverged += ( merged_positions [ i ] - characters [ i ].position ).length_squared ( ) > 0.0001f;
+          }
+
+          Real64 updates = static_cast<Real64>( iterations ) * c_frames_per_iteration * c_character_count;
+
+          printf ( "  %-10s %4u solid tiles in %3u walls\n", c_wall_layout_names [ layout ],
+                   solid_count, map.wall_count ( ) );
+          printf ( "  %-10s %8.3f ns/update\n", "per tile", ticks_to_ns ( ticks [ 1 ] ) / updates );
+          printf ( "  %-10s %8.3f ns/update %6.2fx, %u characters ended up elsewhere\n", "merged",
+                   ticks_to_ns ( ticks [ 0 ] ) / updates,
+                   static_cast<Real64>( ticks [ 1 ] ) / static_cast<Real64>( ticks [ 0 ] ), diverged );
+     }
+}
+
+// puts every character walking with velocity already built up, so each mode starts from the same state
+static Void spawn_kinematics_characters ( Character* characters, Vector* walks, Uint32 count )
+{
+     for ( Uint32 i = 0; i < count; ++i ) {
+          Auto& character = characters [ i ];
+
+          character = Character ( );
+
+          character.position.set ( random_real ( 0.0f, 16.0f ), random_real ( 0.0f, 16.0f ) );
+          character.velocity.set ( random_real ( -2.0f, 2.0f ), random_real ( -2.0f, 2.0f ) );
+          character.deceleration_scale = 5.0f;
+          character.on_ice = ( i % 8 ) == 0;
+
+          walks [ i ].set ( random_real ( -9.0f, 9.0f ), random_real ( -9.0f, 9.0f ) );
+     }
+}
+
+static Void bench_kinematics ( Uint32 iterations )
+{
+     static const Uint32 c_character_count = 1024;
+     static const Uint32 c_batch_size = 64;
+     static const Real32 c_frame_time = 1.0f / 60.0f;
+
+     enum Mode {
+          one_at_a_time,
+          gathered,
+          persistent,
+          mode_count
+     };
+
+     static const Char8* c_mode_names [ mode_count ] = {
+          "one",
+          "gathered",
+          "persistent"
+     };
+
+     static Character characters [ c_character_count ];
+     static Vector walks [ c_character_count ];
+     static Vector positions [ mode_count ] [ c_character_count ];
+     static KinematicsBatch<1> single;
+     static KinematicsBatch<c_batch_size> batch;
+
+     // what the hot fields would look like if the manager owned them between steps, as a floor
+     // for what keeping them there could save over gathering them into batches each step
+     static Real32 position_x [ c_character_count ];
+     static Real32 position_y [ c_character_count ];
+     static Real32 velocity_x [ c_character_count ];
+     static Real32 velocity_y [ c_character_count ];
+     static Real32 acceleration_x [ c_character_count ];
+     static Real32 acceleration_y [ c_character_count ];
+     static Real32 deceleration [ c_character_count ];
+
+     Uint64 ticks [ mode_count ];
+     Real64 updates = static_cast<Real64>( iterations ) * c_character_count;
+
+     printf ( "kinematics: %u characters for %u steps per run\n", c_character_count, iterations );
+
+     for ( Int32 m = 0; m < mode_count; ++m ) {
+          g_seed = 0x2545F491;
+
+          spawn_kinematics_characters ( characters, walks, c_character_count );
+
+          for ( Uint32 i = 0; i < c_character_count; ++i ) {
+               Auto& character = characters [ i ];
+
+               position_x [ i ] = character.position.x ( );
+               position_y [ i ] = character.position.y ( );
+               velocity_x [ i ] = character.velocity.x ( );
+               velocity_y [ i ] = character.velocity.y ( );
+               deceleration [ i ] = character.on_ice ? -( Character::c_ice_decel * character.deceleration_scale ) :
+                                                       -character.deceleration_scale;
+          }
+
+          Uint64 start = SDL_GetPerformanceCounter ( );
+
+          for ( Uint32 it = 0; it < iterations; ++it ) {
+               switch ( m ) {
+               case one_at_a_time:
+                    for ( Uint32 i = 0; i < c_character_count; ++i ) {
+                         Auto& character = characters [ i ];
+
+                         character.acceleration = walks [ i ];
+
+                         single.clear ( );
+                         single.add ( character );
+                         single.integrate ( c_frame_time );
+                         character.position += single.finish ( 0 );
+                    }
+                    break;
+               case gathered:
+                    for ( Uint32 b = 0; b < c_character_count; b += c_batch_size ) {
+                         batch.clear ( );
+
+                         for ( Uint32 i = b; i < c_character_count && batch.count < c_batch_size; ++i ) {
+                              characters [ i ].acceleration = walks [ i ];
+                              batch.add ( characters [ i ] );
+                         }
+
+                         batch.integrate ( c_frame_time );
+
+                         for ( Uint32 k = 0; k < batch.count; ++k ) {
+                              batch.characters [ k ]->position += batch.finish ( k );
+                         }
+                    }
+                    break;
+               case persistent:
+               {
+                    Real32 half_time_delta_squared = 0.5f * square ( c_frame_time );
+
+                    for ( Uint32 i = 0; i < c_character_count; ++i ) {
+                         acceleration_x [ i ] = walks [ i ].x ( );
+                         acceleration_y [ i ] = walks [ i ].y ( );
+                    }
+
+                    for ( Uint32 i = 0; i < c_character_count; ++i ) {
+                         acceleration_x [ i ] += velocity_x [ i ] * deceleration [ i ];
+                         acceleration_y [ i ] += velocity_y [ i ] * deceleration [ i ];
+
+                         position_x [ i ] += ( velocity_x [ i ] * c_frame_time ) +
+                                             ( acceleration_x [ i ] * half_time_delta_squared );
+                         position_y [ i ] += ( velocity_y [ i ] * c_frame_time ) +
+                                             ( acceleration_y [ i ] * half_time_delta_squared );
+
+                         velocity_x [ i ] = ( acceleration_x [ i ] * c_frame_time ) + velocity_x [ i ];
+                         velocity_y [ i ] = ( acceleration_y [ i ] * c_frame_time ) + velocity_y [ i ];
+                    }
+               } break;
+               }
+          }
+
+          ticks [ m ] = SDL_GetPerformanceCounter ( ) - start;
+
+          for ( Uint32 i = 0; i < c_character_count; ++i ) {
+               positions [ m ] [ i ] = m == persistent ? Vector { position_x [ i ], position_y [ i ] } :
+                                                         characters [ i ].position;
+          }
+     }
+
+     for ( Int32 m = 0; m < mode_count; ++m ) {
+          // every mode does the same float operations in the same order, so they agree exactly
+          Uint32 mismatches = 0;
+
+          for ( Uint32 i = 0; i < c_character_count; ++i ) {
+               mismatches += positions [ m ] [ i ].x ( ) != positions [ one_at_a_time ] [ i ].x ( ) ||
+                             positions [ m ] [ i ].y ( ) != positions [ one_at_a_time ] [ i ].y ( );
+          }
+
+          printf ( "  %-10s %8.3f ns/update %6.2fx %s\n", c_mode_names [ m ], ticks_to_ns ( ticks [ m ] ) / updates,
+                   static_cast<Real64>( ticks [ one_at_a_time ] ) / static_cast<Real64>( ticks [ m ] ),
+                   mismatches ? "MISMATCH" : "" );
+     }
+}
+
+// how the map was lit before lamps were cached, everything relit every frame
+static Void reference_illuminate ( Uint8* light, Int32 width, Int32 height, Uint8 base,
+                                   const Location& loc, Uint8 value )
+{
+     Int32 radius = ( ( value - base ) / Map::c_light_decay );
+
+     if ( radius < 0 ) {
+          return;
+     }
+
+     radius++;
+
+     Int32 min_x  = loc.x - radius;
+     Int32 max_x  = loc.x + radius;
+     Int32 min_y  = loc.y - radius;
+     Int32 max_y  = loc.y + radius;
+
+     CLAMP ( min_x, 0, width - 1 );
+     CLAMP ( max_x, 0, width - 1 );
+     CLAMP ( min_y, 0, height - 1 );
+     CLAMP ( max_y, 0, height - 1 );
+
+     for ( Int32 j = min_y; j <= max_y; ++j ) {
+          for ( Int32 i = min_x; i <= max_x; ++i ) {
+               Real32 diff_x = static_cast<Real32>( loc.x - i );
+               Real32 diff_y = static_cast<Real32>( loc.y - j );
+               Int32 distance = static_cast<Int32>( sqrt ( diff_x * diff_x + diff_y * diff_y ) ) - 1;
+
+               if ( distance < 0 ) {
+                    distance = 0;
+               }
+
+               if ( distance > radius ) {
+                    continue;
+               }
+
+               Uint8& light_value     = light [ j * width + i ];
+               Uint8  new_light_value = value - ( distance * Map::c_light_decay );
+
+               if ( light_value < new_light_value ) {
+                    light_value = new_light_value;
+               }
+          }
+     }
+}
+
+static Void reference_light ( Map& map, const Map::LightSource* sources, Int32 source_count, Uint8* light )
+{
+     for ( Int32 i = 0; i < map.width ( ) * map.height ( ); ++i ) {
+          light [ i ] = map.base_light_value ( );
+     }
+
+     for ( Uint8 i = 0; i < map.lamp_count ( ); ++i ) {
+          reference_illuminate ( light, map.width ( ), map.height ( ), map.base_light_value ( ),
+                                 Location ( map.lamp ( i ).coordinates ), Map::c_lamp_light );
+     }
+
+     for ( Int32 i = 0; i < source_count; ++i ) {
+          reference_illuminate ( light, map.width ( ), map.height ( ), map.base_light_value ( ),
+                                 sources [ i ].location, sources [ i ].value );
+     }
+}
+
+static const Int32 c_light_projectile_count = 4;
+static const Int32 c_max_light_torches = Map::c_max_light_sources - c_light_projectile_count;
+
+struct LightScene {
+     const Char8* name;
+     Uint32 lamp_count;
+     Int32 torch_count;
+};
+
+static const LightScene c_light_scenes [ ] = {
+     { "lamps", Map::c_max_lamps, 8 },
+     { "torches", 0, 48 },
+};
+
+// torches stay put but go out now and then, fire arrows cross the map a tile every few frames
+static Int32 light_sources_for_frame ( Uint32 frame, const Location* torches, Int32 torch_count,
+                                       Map::LightSource* sources )
+{
+     Int32 count = 0;
+
+     for ( Int32 i = 0; i < torch_count; ++i ) {
+          if ( ( ( frame + i * 11 ) / 90 ) % 4 == 0 ) {
+               continue;
+          }
+
+          sources [ count ].location = torches [ i ];
+          sources [ count ].value = 200;
+          sources [ count ].color = Map::c_fire_light;
+          count++;
+     }
+
+     for ( Int32 i = 0; i < c_light_projectile_count; ++i ) {
+          Int32 travelled = static_cast<Int32>( ( frame + i * 37 ) / 4 ) % 40;
+
+          sources [ count ].location = Location ( travelled - 4, 4 + i * 7 );
+          sources [ count ].value = LightDetector::c_bryte_value - 1;
+          sources [ count ].color = Map::c_fire_light;
+          count++;
+     }
+
+     return count;
+}
+
+static Void light_map ( Map& map, const Map::LightSource* sources, Int32 count )
+{
+     map.begin_light ( );
+
+     for ( Int32 i = 0; i < count; ++i ) {
+          map.add_light ( sources [ i ].location, sources [ i ].value, sources [ i ].color );
+     }
+
+     map.end_light ( );
+}
+
+static Void bench_light ( Uint32 iterations )
+{
+     static const Uint32 c_frames_per_iteration = 60;
+
+     // the game never constructs a map, it lives in zeroed game memory
+     static Uint64 map_memory [ ( sizeof ( Map ) + sizeof ( Uint64 ) - 1 ) / sizeof ( Uint64 ) ];
+     static Uint8 reference [ Map::c_max_tiles ];
+
+     Auto& map = *reinterpret_cast<Map*>( map_memory );
+     Location torches [ c_max_light_torches ];
+     Map::LightSource sources [ Map::c_max_light_sources ];
+     Uint32 frames = iterations * c_frames_per_iteration;
+
+     printf ( "light: %d fire arrows for %u frames\n", c_light_projectile_count, frames );
+
+     for ( Uint32 s = 0; s < sizeof ( c_light_scenes ) / sizeof ( c_light_scenes [ 0 ] ); ++s ) {
+          Auto& scene = c_light_scenes [ s ];
+
+          g_seed = 0x2545F491 + s;
+
+          map.initialize ( 32, 32 );
+          map.set_lamp_palette ( nullptr );
+
+          // dark enough that the lamps reach far enough for their edges to wrap around
+          map.set_base_light ( 16 );
+
+          for ( Uint32 i = 0; i < scene.lamp_count; ++i ) {
+               map.add_lamp ( Location ( static_cast<Int32>( next_random ( ) % 32 ),
+                                         static_cast<Int32>( next_random ( ) % 32 ) ), 0 );
+          }
+
+          for ( Int32 i = 0; i < scene.torch_count; ++i ) {
+               torches [ i ] = Location ( static_cast<Int32>( next_random ( ) % 32 ),
+                                          static_cast<Int32>( next_random ( ) % 32 ) );
+          }
+
+          map.reset_light ( );
+
+          Uint64 start = SDL_GetPerformanceCounter ( );
+
+          for ( Uint32 f = 0; f < frames; ++f ) {
+               Int32 count = light_sources_for_frame ( f, torches, scene.torch_count, sources );
+               reference_light ( map, sources, count, reference );
+          }
+
+          Uint64 sqrt_ticks = SDL_GetPerformanceCounter ( ) - start;
+
+          start = SDL_GetPerformanceCounter ( );
+
+          for ( Uint32 f = 0; f < frames; ++f ) {
+               Int32 count = light_sources_for_frame ( f, torches, scene.torch_count, sources );
+
+               map.reset_light ( );
+               light_map ( map, sources, count );
+          }
+
+          Uint64 stamp_ticks = SDL_GetPerformanceCounter ( ) - start;
+
+          start = SDL_GetPerformanceCounter ( );
+
+          for ( Uint32 f = 0; f < frames; ++f ) {
+               Int32 count = light_sources_for_frame ( f, torches, scene.torch_count, sources );
+               light_map ( map, sources, count );
+          }
+
+          Uint64 incremental_ticks = SDL_GetPerformanceCounter ( ) - start;
+
+          // both have to light every tile the same, including where a dim source's edge wraps around
+          Uint32 mismatched_frames = 0;
+
+          map.reset_light ( );
+
+          for ( Uint32 f = 0; f < frames; ++f ) {
+               Int32 count = light_sources_for_frame ( f, torches, scene.torch_count, sources );
+
+               reference_light ( map, sources, count, reference );
+               light_map ( map, sources, count );
+
+               for ( Location tile; tile.y < map.height ( ); ++tile.y ) {
+                    for ( tile.x = 0; tile.x < map.width ( ); ++tile.x ) {
+                         if ( map.get_tile_location_light ( tile ) != reference [ map.location_to_tile_index ( tile ) ] ) {
+                              mismatched_frames++;
+                              tile.y = map.height ( );
+                              break;
+                         }
+                    }
+               }
+          }
+
+          printf ( "  %-8s %2u lamps, %2d torches\n", scene.name, scene.lamp_count, scene.torch_count );
+          printf ( "  %-8s %10.3f ns/frame relighting everything with sqrt\n", "sqrt", ticks_to_ns ( sqrt_ticks ) / frames );
+          printf ( "  %-8s %10.3f ns/frame relighting everything %6.2fx\n", "stamps",
+                   ticks_to_ns ( stamp_ticks ) / frames,
+                   static_cast<Real64>( sqrt_ticks ) / static_cast<Real64>( stamp_ticks ) );
+          printf ( "  %-8s %10.3f ns/frame %6.2fx, %u frames differ\n", "changed",
+                   ticks_to_ns ( incremental_ticks ) / frames,
+                   static_cast<Real64>( sqrt_ticks ) / static_cast<Real64>( incremental_ticks ), mismatched_frames );
+     }
+}
+
+// the float blend render_light ( ) did per pixel before the rows were blended in fixed point
+static Void reference_blend_light_row ( Uint32* pixels, const Uint8* lights, Int32 count )
+{
+     for ( Int32 i = 0; i < count; ++i ) {
+          Uint8* bytes = reinterpret_cast<Uint8*>( pixels + i );
+          Real32 light = static_cast<Real32>( lights [ i ] ) / 255.0f;
+
+          for ( Int32 c = 0; c < 3; ++c ) {
+               bytes [ c ] = static_cast<Uint8>( static_cast<Real32>( bytes [ c ] ) * light );
+          }
+     }
+}
+
+static Void bench_blend ( Uint32 iterations )
+{
+     // a back buffer's worth of pixels
+     static const Int32 c_row_width = 256;
+     static const Int32 c_row_count = 240;
+     static const Int32 c_pixel_count = c_row_width * c_row_count;
+
+     static Uint32 source [ c_pixel_count ];
+     static Uint32 expected [ c_pixel_count ];
+     static Uint32 pixels [ c_pixel_count ];
+     static Uint32 lights [ c_pixel_count ];
+     static Uint8 light_bytes [ c_pixel_count ];
+
+     for ( Int32 i = 0; i < c_pixel_count; ++i ) {
+          source [ i ] = next_random ( );
+          light_bytes [ i ] = next_random ( ) % 256;
+          lights [ i ] = 0xFF000000 | ( light_bytes [ i ] * 0x010101 );
+     }
+
+     Uint64 pixels_blended = static_cast<Uint64>( iterations ) * c_pixel_count;
+
+     memcpy ( pixels, source, sizeof ( pixels ) );
+
+     Uint64 start = SDL_GetPerformanceCounter ( );
+
+     for ( Uint32 it = 0; it < iterations; ++it ) {
+          for ( Int32 r = 0; r < c_row_count; ++r ) {
+               reference_blend_light_row ( pixels + r * c_row_width, light_bytes + r * c_row_width, c_row_width );
+          }
+     }
+
+     Uint64 float_ticks = SDL_GetPerformanceCounter ( ) - start;
+
+     // blending once is what the comparisons are against
+     memcpy ( expected, source, sizeof ( expected ) );
+     reference_blend_light_row ( expected, light_bytes, c_pixel_count );
+
+     printf ( "blend: %llu pixels per run\n", static_cast<unsigned long long>( pixels_blended ) );
+     printf ( "  %-8s %8.3f ns/pixel\n", "float", ticks_to_ns ( float_ticks ) / pixels_blended );
+
+     LightKernel selected = light_kernel ( );
+
+     for ( Int32 k = LightKernel::light_scalar; k < LightKernel::light_kernel_count; ++k ) {
+          Auto kernel = static_cast<LightKernel>( k );
+
+          if ( !set_light_kernel ( kernel ) ) {
+               continue;
+          }
+
+          // float rounding lands a step low now and then, anything further off is a bug
+          Uint32 off_by_one = 0;
+          Uint32 mismatches = 0;
+
+          memcpy ( pixels, source, sizeof ( pixels ) );
+
+          for ( Int32 r = 0; r < c_row_count; ++r ) {
+               blend_light_row ( pixels + r * c_row_width, lights + r * c_row_width, c_row_width );
+          }
+
+          for ( Int32 i = 0; i < c_pixel_count; ++i ) {
+               for ( Int32 c = 0; c < 4; ++c ) {
+                    Int32 difference = static_cast<Int32>( ( pixels [ i ] >> ( c * 8 ) ) & 0xFF ) -
+                                       static_cast<Int32>( ( expected [ i ] >> ( c * 8 ) ) & 0xFF );
+
+                    if ( difference == 1 && c < 3 ) {
+                         off_by_one++;
+                    } else if ( difference ) {
+                         mismatches++;
+                    }
+               }
+          }
+
+          start = SDL_GetPerformanceCounter ( );
+
+          for ( Uint32 it = 0; it < iterations; ++it ) {
+               for ( Int32 r = 0; r < c_row_count; ++r ) {
+                    blend_light_row ( pixels + r * c_row_width, lights + r * c_row_width, c_row_width );
+               }
+          }
+
+          Uint64 ticks = SDL_GetPerformanceCounter ( ) - start;
+
+          printf ( "  %-8s %8.3f ns/pixel %6.2fx, %u channels a step brighter %s\n", light_kernel_name ( kernel ),
+                   ticks_to_ns ( ticks ) / pixels_blended,
+                   static_cast<Real64>( float_ticks ) / static_cast<Real64>( ticks ), off_by_one,
+                   mismatches ? "MISMATCH" : "" );
+     }
+
+     set_light_kernel ( selected );
+}
+
+static const MicroBenchmark c_benchmarks [ ] = {
+     { "collision", bench_collision },
+     { "walls", bench_walls },
+     { "kinematics", bench_kinematics },
+     { "light", bench_light },
+     { "blend", bench_blend },
+};
+
+static const Uint32 c_benchmark_count = sizeof ( c_benchmarks ) / sizeof ( c_benchmarks [ 0 ] );
+
+int main ( int argc, char** argv )
+{
+     Uint32 iterations = 1000;
+     Bool any_named = false;
+     Bool selected [ c_benchmark_count ] = { };
+
+     for ( int i = 1; i < argc; ++i ) {
+          if ( strcmp ( argv [ i ], "-h" ) == 0 ) {
+               print_help ( );
+               return 0;
+          } else if ( strcmp ( argv [ i ], "-l" ) == 0 ) {
+               for ( Uint32 b = 0; b < c_benchmark_count; ++b ) {
+                    printf ( "%s\n", c_benchmarks [ b ].name );
+               }
+               return 0;
+          } else if ( strcmp ( argv [ i ], "-n" ) == 0 && i + 1 < argc ) {
+               iterations = atoi ( argv [ ++i ] );
+          } else {
+               Bool found = false;
+
+               for ( Uint32 b = 0; b < c_benchmark_count; ++b ) {
+                    if ( strcmp ( argv [ i ], c_benchmarks [ b ].name ) == 0 ) {
+                         selected [ b ] = true;
+                         found = true;
+                    }
+               }
+
+               if ( !found ) {
+                    printf ( "Unknown benchmark '%s'\n", argv [ i ] );
+                    print_help ( );
+                    return 1;
+               }
+
+               any_named = true;
+          }
+     }
+
+     for ( Uint32 b = 0; b < c_benchmark_count; ++b ) {
+          if ( !any_named || selected [ b ] ) {
+               c_benchmarks [ b ].run ( iterations );
+          }
+     }
+
+     return 0;
+}
@@ -0,0 +1,197 @@
+#include "Benchmark.hpp"
+#include "Log.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+
+#include <cstdio>
+#include <cstdlib>
+
+const Char8* Benchmark::c_stage_names [ Stage::count ] = {
+     "update",
+     "render",
+     "present"
+};
+
+struct StageSummary {
+     Real64 min;
+     Real64 p50;
+     Real64 p99;
+     Real64 max;
+     Real64 mean;
+};
+
+static StageSummary summarize ( Uint64* sorted_samples, Uint32 count, Real64 ms_per_tick )
+{
+     StageSummary summary {};
+
+     if ( !count ) {
+          return summary;
+     }
+
+     Uint64 total = 0;
+
+     for ( Uint32 i = 0; i < count; ++i ) {
+          total += sorted_samples [ i ];
+     }
+
+     summary.min  = sorted_samples [ 0 ] * ms_per_tick;
+     summary.p50  = sorted_samples [ ( count - 1 ) / 2 ] * ms_per_tick;
+     summary.p99  = sorted_samples [ ( ( count - 1 ) * 99 ) / 100 ] * ms_per_tick;
+     summary.max  = sorted_samples [ count - 1 ] * ms_per_tick;
+     summary.mean = ( static_cast<Real64>( total ) / count ) * ms_per_tick;
+
+     return summary;
+}
+
+Benchmark::Benchmark ( ) :
+     m_frame_count     ( 0 ),
+     m_max_frame_count ( 0 )
+{
+     for ( Uint32 i = 0; i < Stage::count; ++i ) {
+          m_samples [ i ] = nullptr;
+          m_stage_start [ i ] = 0;
+     }
+}
+
+Benchmark::~Benchmark ( )
+{
+     free_samples ( );
+}
+
+Bool Benchmark::start ( Uint32 max_frame_count )
+{
+     free_samples ( );
+
+     for ( Uint32 i = 0; i < Stage::count; ++i ) {
+          m_samples [ i ] = reinterpret_cast<Uint64*>( calloc ( max_frame_count, sizeof ( Uint64 ) ) );
+
+          if ( !m_samples [ i ] ) {
+               LOG_ERROR ( "Failed to allocate benchmark samples for %u frames\n", max_frame_count );
+               free_samples ( );
+               return false;
+          }
+     }
+
+     m_frame_count     = 0;
+     m_max_frame_count = max_frame_count;
+
+     return true;
+}
+
+Void Benchmark::end_frame ( )
+{
+     if ( m_frame_count < m_max_frame_count ) {
+          m_frame_count++;
+     }
+}
+
+Bool Benchmark::write_report ( const Char8* path, Bool headless ) const
+{
+     FILE* file = fopen ( path, "w" );
+
+     if ( !file ) {
+          LOG_ERROR ( "Failed to open '%s' to write benchmark report\n", path );
+          return false;
+     }
+
+     Real64 ms_per_tick = 1000.0 / static_cast<Real64>( SDL_GetPerformanceFrequency ( ) );
+
+     Uint64* sorted = reinterpret_cast<Uint64*>( calloc ( m_frame_count + 1, sizeof ( Uint64 ) ) );
+     Uint64* frames = reinterpret_cast<Uint64*>( calloc ( m_frame_count + 1, sizeof ( Uint64 ) ) );
+
+     if ( !sorted || !frames ) {
+          LOG_ERROR ( "Failed to allocate benchmark report for %u frames\n", m_frame_count );
+          free ( sorted );
+          free ( frames );
+          fclose ( file );
+          return false;
+     }
+
+     fprintf ( file, "{\n" );
+     fprintf ( file, "  \"frames\": %u,\n", m_frame_count );
+     fprintf ( file, "  \"stages\": {\n" );
+
+     for ( Uint32 s = 0; s < Stage::count; ++s ) {
+          for ( Uint32 i = 0; i < m_frame_count; ++i ) {
+               sorted [ i ] = m_samples [ s ] [ i ];
+               frames [ i ] += m_samples [ s ] [ i ];
+          }
+
+          std::sort ( sorted, sorted + m_frame_count );
+
+          Auto summary = summarize ( sorted, m_frame_count, ms_per_tick );
+          const Char8* separator = ( s + 1 < Stage::count ) ? "," : "";
+
+          // NOTE: there is nothing to present to without a window
+          if ( headless && s == Stage::present ) {
+               fprintf ( file, "    \"%s\": null%s\n", c_stage_names [ s ], separator );
+               continue;
+          }
+
+          fprintf ( file, "    \"%s\": { \"min_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, "
+                    "\"max_ms\": %.4f, \"mean_ms\": %.4f }%s\n",
+                    c_stage_names [ s ], summary.min, summary.p50, summary.p99,
+                    summary.max, summary.mean, separator );
+     }
+
+     fprintf ( file, "  },\n" );
+
+     // whole frame times bucketed by millisecond, the last bucket collects everything slower
+     Uint32 histogram [ c_histogram_bucket_count ] = {};
+
+     for ( Uint32 i = 0; i < m_frame_count; ++i ) {
+          Uint32 bucket = static_cast<Uint32>( frames [ i ] * ms_per_tick );
+
+          if ( bucket >= c_histogram_bucket_count ) {
+               bucket = c_histogram_bucket_count - 1;
+          }
+
+          histogram [ bucket ]++;
+     }
+
+     std::sort ( frames, frames + m_frame_count );
+
+     Auto frame_summary = summarize ( frames, m_frame_count, ms_per_tick );
+
+     fprintf ( file, "  \"frame\": { \"min_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, "
+               "\"max_ms\": %.4f, \"mean_ms\": %.4f },\n",
+               frame_summary.min, frame_summary.p50, frame_summary.p99,
+               frame_summary.max, frame_summary.mean );
+
+     fprintf ( file, "  \"histogram\": { \"bucket_ms\": 1, \"counts\": [ " );
+
+     for ( Uint32 i = 0; i < c_histogram_bucket_count; ++i ) {
+          fprintf ( file, "%u%s", histogram [ i ], ( i + 1 < c_histogram_bucket_count ) ? ", " : " " );
+     }
+
+     fprintf ( file, "] }\n" );
+     fprintf ( file, "}\n" );
+
+     free ( sorted );
+     free ( frames );
+
+     fclose ( file );
+
+     LOG_INFO ( "Wrote benchmark report for %u frames to '%s'\n", m_frame_count, path );
+
+     return true;
+}
+
+Uint64 Benchmark::now ( )
+{
+     return SDL_GetPerformanceCounter ( );
+}
+
+Void Benchmark::free_samples ( )
+{
+     for ( Uint32 i = 0; i < Stage::count; ++i ) {
+          free ( m_samples [ i ] );
+          m_samples [ i ] = nullptr;
+     }
+
+     m_frame_count     = 0;
+     m_max_frame_count = 0;
+}
+
@@ -0,0 +1,80 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include "Types.hpp"
+
+// Times each stage of every frame in a run and reports percentiles and a frame time histogram
+class Benchmark {
+public:
+
+     enum Stage {
+          update,
+          render,
+          present,
+          count
+     };
+
+     Benchmark ( );
+     ~Benchmark ( );
+
+     Bool start ( Uint32 max_frame_count );
+
+     inline Void begin_stage ( Stage stage );
+     inline Void end_stage ( Stage stage );
+
+     Void end_frame ( );
+
+     inline Uint32 frame_count ( ) const;
+     inline Bool full ( ) const;
+
+     // writes the results as json
+     Bool write_report ( const Char8* path, Bool headless ) const;
+
+public:
+
+     // an hour of play at 30 frames per second
+     static const Uint32 c_default_max_frame_count = 108000;
+
+private:
+
+     static Uint64 now ( );
+
+     Void free_samples ( );
+
+private:
+
+     static const Uint32 c_histogram_bucket_count = 64;
+     static const Char8* c_stage_names [ Stage::count ];
+
+     // ticks spent in each stage, per frame
+     Uint64* m_samples [ Stage::count ];
+     Uint64  m_stage_start [ Stage::count ];
+
+     Uint32  m_frame_count;
+     Uint32  m_max_frame_count;
+};
+
+inline Void Benchmark::begin_stage ( Stage stage )
+{
+     m_stage_start [ stage ] = now ( );
+}
+
+inline Void Benchmark::end_stage ( Stage stage )
+{
+     if ( m_frame_count < m_max_frame_count ) {
+          m_samples [ stage ] [ m_frame_count ] += now ( ) - m_stage_start [ stage ];
+     }
+}
+
+inline Uint32 Benchmark::frame_count ( ) const
+{
+     return m_frame_count;
+}
+
+inline Bool Benchmark::full ( ) const
+{
+     return m_frame_count >= m_max_frame_count;
+}
+
+#endif
+
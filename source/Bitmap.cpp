@@ -124,13 +124,13 @@ extern "C" SDL_Surface* load_bitmap ( const FileContents* bitmap_contents )
 Bool load_bitmap_with_game_memory ( SDL_Surface*& surface, GameMemory& game_memory, const Char8* filepath )
 {
      LOG_DEBUG ( "Loading bitmap: %s\n", filepath );
+     GameMemory::ScopedMarker scratch ( game_memory, GameMemory::Arena::frame );
      FileContents bitmap_contents = load_entire_file ( filepath, &game_memory );
      surface = load_bitmap ( &bitmap_contents );
      if ( !surface ) {
           return false;
      }
 
-     GAME_POP_MEMORY_ARRAY ( game_memory, Char8, bitmap_contents.size );
      return true;
 }
 
@@ -24,9 +24,47 @@ static Void render_hearts ( SDL_Surface* back_buffer, SDL_Surface* heart_sheet,
 
 const Real32 State::c_pickup_show_time = 2.0f;
 
+
+// enemies integrate this many at a time, the batch lives on the stack
+static const Uint32 c_kinematics_batch_size = 64;
+
+#ifdef PROFILE
+static const Char8* c_profile_trace_filepath = "bryte_trace.json";
+#endif
+
+// only the first failure warns, the rest are counted and reported when the game shuts down
+template < typename E, EntityHandle::Pool POOL >
+static Void warn_pool_full ( const EntityManager<E, POOL>& pool, const Char8* name )
+{
+     if ( pool.spawn_failures == 1 ) {
+          LOG_WARNING ( "%s pool is full at %u, spawns are failing\n", name, pool.capacity );
+     }
+}
+
+// the region sheets this run loaded last. State's copies of the pointers are snapshotted with it, so
+// after memory is rolled back they may be ones freed by a later change_region ( ), these are the
+// ones that still exist. statics are reset each time the game code is reloaded
+struct RegionSheets {
+     MapDisplay          map_display;
+     InteractivesDisplay interactives_display;
+     Int32               region_index;
+     Bool                loaded;
+};
+
+static RegionSheets g_region_sheets;
+
 static State* get_state ( GameMemory& game_memory )
 {
-     return reinterpret_cast<MemoryLocations*>( game_memory.location ( ) )->state;
+     return reinterpret_cast<MemoryLocations*>( game_memory.arena_location ( GameMemory::Arena::permanent ) )->state;
+}
+
+static Void set_projectile_collision_points ( )
+{
+     // projectile collision for various directions
+     Projectile::collision_points [ Direction::left ].set ( pixels_to_meters ( 1 ), pixels_to_meters ( 7 ) );
+     Projectile::collision_points [ Direction::up ].set ( pixels_to_meters ( 7 ), pixels_to_meters ( 14 ) );
+     Projectile::collision_points [ Direction::right ].set ( pixels_to_meters ( 14 ), pixels_to_meters ( 7 ) );
+     Projectile::collision_points [ Direction::down ].set ( pixels_to_meters ( 7 ), pixels_to_meters ( 1 ) );
 }
 
 static Location character_adjacent_tile ( const Character& character )
@@ -169,6 +207,10 @@ Bool State::initialize ( GameMemory& game_memory, Settings* settings )
 
      random.seed ( 13371 );
 
+#ifdef PROFILE
+     profiler.clear ( );
+#endif
+
      current_region = settings->region_index;
 
      player_spawn_tile.x = settings->player_spawn_tile_x;
@@ -189,6 +231,10 @@ Bool State::initialize ( GameMemory& game_memory, Settings* settings )
      item_key = false;
      switch_item_key = false;
 
+     if ( !allocate_pools ( game_memory ) ) {
+          return false;
+     }
+
      // clear entity managers
      pickups.clear ( );
      projectiles.clear ( );
@@ -196,11 +242,7 @@ Bool State::initialize ( GameMemory& game_memory, Settings* settings )
      emitters.clear ( );
      enemies.clear ( );
 
-     // projectile collision for various directions
-     Projectile::collision_points [ Direction::left ].set ( pixels_to_meters ( 1 ), pixels_to_meters ( 7 ) );
-     Projectile::collision_points [ Direction::up ].set ( pixels_to_meters ( 7 ), pixels_to_meters ( 14 ) );
-     Projectile::collision_points [ Direction::right ].set ( pixels_to_meters ( 14 ), pixels_to_meters ( 7 ) );
-     Projectile::collision_points [ Direction::down ].set ( pixels_to_meters ( 7 ), pixels_to_meters ( 1 ) );
+     set_projectile_collision_points ( );
 
      // clear animations
      character_display.fire_animation.clear ( );
@@ -216,6 +258,36 @@ Bool State::initialize ( GameMemory& game_memory, Settings* settings )
 
      pickup_stopwatch.reset ( c_pickup_show_time );
 
+     // NOTE: init map display textures to null so we don't clean them up
+     // if they aren't loaded
+     map_display.clear ( );
+
+     if ( !load_assets ( game_memory ) ) {
+          return false;
+     }
+
+     slot_menu.init ( 154, 122 );
+     slot_menu.add_option ( "SLOT 0" );
+     slot_menu.add_option ( "SLOT 1" );
+     slot_menu.add_option ( "SLOT 2" );
+     slot_menu.add_option ( "QUIT" );
+
+     pause_menu.init ( 154, 122 );
+     pause_menu.add_option ( "RESUME" );
+     pause_menu.add_option ( "SAVE" );
+     pause_menu.add_option ( "MENU" );
+
+#ifdef DEBUG
+     enemy_think = true;
+     invincible = false;
+     debug_text = true;
+#endif
+
+     return true;
+}
+
+Bool State::load_assets ( GameMemory& game_memory )
+{
      // load title sheet
      if ( !load_bitmap_with_game_memory ( title_surface, game_memory, "content/images/title_screen.bmp" ) ) {
           return false;
@@ -226,10 +298,6 @@ Bool State::initialize ( GameMemory& game_memory, Settings* settings )
           return false;
      }
 
-     // NOTE: init map display textures to null so we don't clean them up
-     // if they aren't loaded
-     map_display.clear ( );
-
      // Load our necessary surfaces
      if ( !character_display.load_surfaces ( game_memory ) ) {
           return false;
@@ -266,39 +334,88 @@ Bool State::initialize ( GameMemory& game_memory, Settings* settings )
 
      back_buffer_format = *bomb_sheet->format;
 
-     slot_menu.init ( 154, 122 );
-     slot_menu.add_option ( "SLOT 0" );
-     slot_menu.add_option ( "SLOT 1" );
-     slot_menu.add_option ( "SLOT 2" );
-     slot_menu.add_option ( "QUIT" );
+     return true;
+}
 
-     pause_menu.init ( 154, 122 );
-     pause_menu.add_option ( "RESUME" );
-     pause_menu.add_option ( "SAVE" );
-     pause_menu.add_option ( "MENU" );
+Bool State::restore ( GameMemory& game_memory, Settings* settings )
+{
+     this->settings = settings;
 
-#ifdef DEBUG
-     enemy_think = true;
-     invincible = false;
-     debug_text = true;
-#endif
+     set_projectile_collision_points ( );
+
+     // NOTE: surfaces and sounds in a restored state belong to whichever run saved it, load our
+     //       own without trying to free theirs
+     if ( !load_assets ( game_memory ) ) {
+          return false;
+     }
+
+     if ( strlen ( region.name ) ) {
+          return load_region_sheets ( game_memory, true );
+     }
 
      return true;
 }
 
-Void State::destroy ( )
+Bool State::resume ( GameMemory& game_memory )
 {
-     sound.unload_effects ( );
+     // rolled back to before a region was loaded, the sheets are freed when the next one is
+     if ( !strlen ( region.name ) ) {
+          return true;
+     }
+
+     // with nothing recorded since the game code was reloaded, the old sheets leak rather than risk
+     // freeing them twice
+     if ( !g_region_sheets.loaded || g_region_sheets.region_index != region.current_index ) {
+          return load_region_sheets ( game_memory, true );
+     }
+
+     // same region, point at the sheets loaded for it but keep the restored animations
+     Auto lamp_animation = map_display.lamp_animation;
+
+     map_display = g_region_sheets.map_display;
+     map_display.lamp_animation = lamp_animation;
+
+     Auto animation = interactives_display.animation;
+     Auto ice_animation = interactives_display.ice_animation;
+     Auto moving_walkway_animation = interactives_display.moving_walkway_animation;
+     Auto ice_sleep_counter = interactives_display.ice_sleep_counter;
+
+     interactives_display = g_region_sheets.interactives_display;
+     interactives_display.animation = animation;
+     interactives_display.ice_animation = ice_animation;
+     interactives_display.moving_walkway_animation = moving_walkway_animation;
+     interactives_display.ice_sleep_counter = ice_sleep_counter;
+
+     return true;
+}
+
+Void State::unload_assets ( )
+{
+     FREE_SURFACE ( title_surface );
+
+     text.unload ( );
 
-     map_display.unload_surfaces ( );
      character_display.unload_surfaces ( );
-     interactives_display.unload_surfaces ( );
      pickup_display.unload_surfaces ( );
      projectile_display.unload_surfaces ( );
 
-     SDL_FreeSurface ( bomb_sheet );
-     SDL_FreeSurface ( player_heart_sheet );
-     SDL_FreeSurface ( upgrade_sheet );
+     FREE_SURFACE ( bomb_sheet );
+     FREE_SURFACE ( player_heart_sheet );
+     FREE_SURFACE ( upgrade_sheet );
+
+     sound.unload_effects ( );
+}
+
+Void State::destroy ( )
+{
+     report_spawn_failures ( );
+
+     unload_assets ( );
+
+     map_display.unload_surfaces ( );
+     interactives_display.unload_surfaces ( );
+
+     g_region_sheets.loaded = false;
 }
 
 Void State::update ( GameMemory& game_memory, Real32 time_delta )
@@ -335,7 +452,7 @@ Void State::handle_input ( GameMemory& game_memory, const GameInput& game_input
      }
 }
 
-Void State::render ( GameMemory& game_memory, SDL_Surface* back_buffer )
+Void State::render ( GameMemory& game_memory, SDL_Surface* back_buffer, Real32 interpolation )
 {
      switch ( game_state ) {
      default:
@@ -344,7 +461,7 @@ Void State::render ( GameMemory& game_memory, SDL_Surface* back_buffer )
           render_intro ( game_memory, back_buffer );
           break;
      case GameState::game:
-          render_game ( game_memory, back_buffer );
+          render_game ( game_memory, back_buffer, interpolation );
           break;
      case GameState::pause:
           render_pause ( game_memory, back_buffer );
@@ -352,6 +469,50 @@ Void State::render ( GameMemory& game_memory, SDL_Surface* back_buffer )
      }
 }
 
+Bool State::allocate_pools ( GameMemory& game_memory )
+{
+     if ( !enemies.allocate ( game_memory, settings->max_enemies, GameMemory::Tag::enemies ) ||
+          !pickups.allocate ( game_memory, settings->max_pickups, GameMemory::Tag::pickups ) ||
+          !projectiles.allocate ( game_memory, settings->max_projectiles, GameMemory::Tag::projectiles ) ||
+          !bombs.allocate ( game_memory, settings->max_bombs, GameMemory::Tag::bombs ) ||
+          !emitters.allocate ( game_memory, settings->max_emitters, GameMemory::Tag::emitters ) ) {
+          return false;
+     }
+
+     if ( !enemy_grid.allocate ( game_memory, settings->max_enemies ) ||
+          !pickup_grid.allocate ( game_memory, settings->max_pickups ) ) {
+          return false;
+     }
+
+     // the grids hold live indices until they are rebuilt, a spawn mustn't reap and shuffle them
+     enemies.reap_on_spawn = false;
+     pickups.reap_on_spawn = false;
+
+     enemy_order = game_memory.push_array<Enemy*> ( settings->max_enemies, GameMemory::Arena::permanent,
+                                                    GameMemory::Tag::enemies );
+
+     if ( !enemy_order ) {
+          return false;
+     }
+
+     LOG_INFO ( "Entity pools: %u enemies, %u pickups, %u projectiles, %u bombs, %u emitters\n",
+                enemies.capacity, pickups.capacity, projectiles.capacity, bombs.capacity, emitters.capacity );
+
+     return true;
+}
+
+Void State::report_spawn_failures ( )
+{
+     if ( !enemies.spawn_failures && !pickups.spawn_failures && !projectiles.spawn_failures &&
+          !bombs.spawn_failures && !emitters.spawn_failures ) {
+          return;
+     }
+
+     LOG_INFO ( "Failed spawns: %u enemies, %u pickups, %u projectiles, %u bombs, %u emitters\n",
+                enemies.spawn_failures, pickups.spawn_failures, projectiles.spawn_failures,
+                bombs.spawn_failures, emitters.spawn_failures );
+}
+
 Void State::quit_game ( )
 {
      LOG_INFO ( "Quitting\n" );
@@ -368,6 +529,17 @@ Void State::update_intro ( GameMemory& game_memory, Real32 time_delta )
 
 Void State::update_game ( GameMemory& game_memory, Real32 time_delta )
 {
+     PROFILE_ZONE ( "update_game" );
+
+     reap_entities ( );
+
+     if ( settings->stress ) {
+          fill_stress_pools ( );
+     }
+
+     build_spatial_grids ( );
+     store_previous_positions ( );
+
      if ( dialogue.get_state ( ) == Dialogue::State::none ) {
           update_player ( game_memory, time_delta );
           update_enemies ( time_delta );
@@ -381,6 +553,7 @@ Void State::update_game ( GameMemory& game_memory, Real32 time_delta )
      }
 
      update_light ( );
+     update_displays ( );
 }
 
 Void State::update_pause ( GameMemory& game_memory, Real32 time_delta )
@@ -445,6 +618,8 @@ Void State::handle_intro_input ( GameMemory& game_memory, const GameInput& game_
 
 Void State::handle_game_input ( GameMemory& game_memory, const GameInput& game_input )
 {
+     PROFILE_ZONE ( "handle_game_input" );
+
      // handle keyboard
      for ( Uint32 i = 0; i < game_input.key_change_count; ++i ) {
           const GameInput::KeyChange& key_change = game_input.key_changes [ i ];
@@ -542,6 +717,14 @@ Void State::handle_game_input ( GameMemory& game_memory, const GameInput& game_i
                }
                break;
 #endif
+
+#ifdef PROFILE
+          case SDL_SCANCODE_G:
+               if ( key_change.down ) {
+                    profiler.export_chrome_trace ( c_profile_trace_filepath );
+               }
+               break;
+#endif
           }
      }
 
@@ -706,12 +889,16 @@ Void State::render_intro ( GameMemory& game_memory, SDL_Surface* back_buffer )
      slot_menu.render ( back_buffer, &text );
 }
 
-Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
+Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer, Real32 interpolation )
 {
+     PROFILE_ZONE ( "render_game" );
+
      Uint32 black  = SDL_MapRGB ( back_buffer->format, 0, 0, 0 );
 
      back_buffer_format = *back_buffer->format;
 
+     begin_interpolation ( interpolation );
+
      // calculate camera
      camera.set_x ( calculate_camera_position ( back_buffer->w, map.width ( ),
                                                 player.position.x ( ), player.width ( ) ) );
@@ -719,46 +906,50 @@ Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
                                                 player.position.y ( ), player.height ( ) ) );
 
      // map
-     map_display.tick ( );
      map_display.render ( back_buffer, map, camera.x ( ), camera.y ( ),
                           map.found_secret ( ) );
 
      // interactives
-     interactives_display.tick ( );
      interactives_display.render ( back_buffer, interactives, map,
                                    camera.x ( ), camera.y ( ), map.found_secret ( ) );
 
-     character_display.tick ( );
+     // enemies in 2 passes, non-flying and flying. A zone per pass rather than per enemy, so a
+     // crowd can't fill the profiler's frame
+     {
+          PROFILE_ZONE ( "render_enemies" );
 
-     // enemies in 2 passes, non-flying and flying
-     for ( Uint32 i = 0; i < enemies.max ( ); ++i ) {
-          Auto& enemy = enemies [ i ];
-          if ( enemy.is_dead ( ) || enemy.flies ) {
-               continue;
-          }
+          for ( Uint32 i = 0; i < enemies.live_size ( ); ++i ) {
+               Auto& enemy = enemies.live ( i );
+               if ( enemy.is_dead ( ) || enemy.flies ) {
+                    continue;
+               }
 
-          character_display.render_enemy ( back_buffer, enemy,
-                                           camera.x ( ), camera.y ( ) );
+               character_display.render_enemy ( back_buffer, enemy,
+                                                camera.x ( ), camera.y ( ) );
+          }
      }
 
      // player
      character_display.render_player ( back_buffer, player,
                                        camera.x ( ), camera.y ( ) );
 
-     for ( Uint32 i = 0; i < enemies.max ( ); ++i ) {
-          Auto& enemy = enemies [ i ];
-          if ( enemy.is_dead ( ) || !enemy.flies ) {
-               continue;
-          }
+     {
+          PROFILE_ZONE ( "render_flying_enemies" );
 
-          character_display.render_enemy ( back_buffer, enemy,
-                                           camera.x ( ), camera.y ( ) );
+          for ( Uint32 i = 0; i < enemies.live_size ( ); ++i ) {
+               Auto& enemy = enemies.live ( i );
+               if ( enemy.is_dead ( ) || !enemy.flies ) {
+                    continue;
+               }
+
+               character_display.render_enemy ( back_buffer, enemy,
+                                                camera.x ( ), camera.y ( ) );
+          }
      }
 
      // pickups
-     pickup_display.tick ( );
-     for ( Uint32 i = 0; i < pickups.max ( ); ++i ) {
-          Auto& pickup = pickups [ i ];
+     for ( Uint32 i = 0; i < pickups.live_size ( ); ++i ) {
+          Auto& pickup = pickups.live ( i );
 
           if ( pickup.is_dead ( ) ) {
                continue;
@@ -768,10 +959,8 @@ Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
      }
 
      // projectiles
-     projectile_display.tick ( );
-
-     for ( Uint32 i = 0; i < projectiles.max ( ); ++i ) {
-          Auto& projectile = projectiles [ i ];
+     for ( Uint32 i = 0; i < projectiles.live_size ( ); ++i ) {
+          Auto& projectile = projectiles.live ( i );
 
           if ( projectile.is_dead ( ) ) {
                continue;
@@ -782,8 +971,8 @@ Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
      }
 
      // bombs
-     for ( Uint32 i = 0; i < bombs.max ( ); ++i ) {
-          Auto& bomb = bombs [ i ];
+     for ( Uint32 i = 0; i < bombs.live_size ( ); ++i ) {
+          Auto& bomb = bombs.live ( i );
 
           if ( bomb.is_dead ( ) ) {
                continue;
@@ -793,8 +982,8 @@ Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
      }
 
      // emitters
-     for ( Uint32 i = 0; i < emitters.max ( ); ++i ) {
-          Auto& emitter = emitters [ i ];
+     for ( Uint32 i = 0; i < emitters.live_size ( ); ++i ) {
+          Auto& emitter = emitters.live ( i );
           if ( emitter.is_alive ( ) ) {
                for ( Uint8 i = 0; i < Emitter::c_max_particles; ++i ) {
                     Auto& particle_lifetime_watch = emitter.particle_lifetime_watches [ i ];
@@ -814,8 +1003,10 @@ Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
                                 pickup_queue [ 0 ], camera.x ( ), camera.y ( ) );
      }
 
+     end_interpolation ( );
+
      // light
-     render_light ( back_buffer, map, camera.x ( ), camera.y ( ) );
+     render_light ( back_buffer, map, camera.x ( ), camera.y ( ), settings->smooth_light );
 
      // damage numbers
 #if 0
@@ -867,15 +1058,16 @@ Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
      }
 #endif
 
-     char buffer [ 64 ];
+     // room for the debug lines with every counter at its widest
+     char buffer [ 160 ];
 
-     sprintf ( buffer, "%d", player.key_count );
+     snprintf ( buffer, sizeof buffer, "%d", player.key_count );
      text.render ( back_buffer, buffer, 235, 4 );
 
-     sprintf ( buffer, "%d", player.bomb_count );
+     snprintf ( buffer, sizeof buffer, "%d", player.bomb_count );
      text.render ( back_buffer, buffer, 210, 4 );
 
-     sprintf ( buffer, "%d", player.arrow_count );
+     snprintf ( buffer, sizeof buffer, "%d", player.arrow_count );
      text.render ( back_buffer, buffer, 185, 4 );
 
      SDL_Rect pickup_dest_rect { 225, 3, Pickup::c_dimension_in_pixels, Pickup::c_dimension_in_pixels };
@@ -894,14 +1086,32 @@ Void State::render_game ( GameMemory& game_memory, SDL_Surface* back_buffer )
      if ( debug_text ) {
           Auto player_loc = Map::vector_to_location ( player.position );
 
-          sprintf ( buffer, "P %.2f %.2f  T %d %d  M %d  AI %s  INV %s",
-                    player.position.x ( ), player.position.y ( ),
-                    player_loc.x, player_loc.y,
-                    map.current_master_map ( ),
-                    enemy_think ? "ON" : "OFF",
-                    invincible ? "ON" : "OFF" );
+          snprintf ( buffer, sizeof buffer, "P %.2f %.2f  T %d %d  M %d  AI %s  INV %s",
+                     player.position.x ( ), player.position.y ( ),
+                     player_loc.x, player_loc.y,
+                     map.current_master_map ( ),
+                     enemy_think ? "ON" : "OFF",
+                     invincible ? "ON" : "OFF" );
 
           text.render ( back_buffer, buffer, 0, 230 );
+
+          Auto permanent_usage = game_memory.usage ( GameMemory::Arena::permanent );
+          Auto frame_usage = game_memory.usage ( GameMemory::Arena::frame );
+
+          snprintf ( buffer, sizeof buffer, "MEM %uK/%uK  FRAME %uK PEAK %uK",
+                     permanent_usage.used / 1024, permanent_usage.capacity / 1024,
+                     frame_usage.frame_high_water / 1024, frame_usage.high_water / 1024 );
+
+          text.render ( back_buffer, buffer, 0, 221 );
+
+          snprintf ( buffer, sizeof buffer, "E %u/%u  J %u/%u  X %u/%u  FAIL %u %u %u %u %u",
+                     enemies.live_size ( ), enemies.capacity,
+                     projectiles.live_size ( ), projectiles.capacity,
+                     emitters.live_size ( ), emitters.capacity,
+                     enemies.spawn_failures, pickups.spawn_failures, projectiles.spawn_failures,
+                     bombs.spawn_failures, emitters.spawn_failures );
+
+          text.render ( back_buffer, buffer, 0, 212 );
      }
 #endif
 }
@@ -921,6 +1131,7 @@ Bool State::spawn_enemy ( const Vector& position, Uint8 id, Direction facing, Pi
      Enemy* enemy = enemies.spawn ( position );
 
      if ( !enemy ) {
+          warn_pool_full ( enemies, "enemy" );
           return false;
      }
 
@@ -930,6 +1141,8 @@ Bool State::spawn_enemy ( const Vector& position, Uint8 id, Direction facing, Pi
 
      enemy->init ( static_cast<Enemy::Type>( id ), position.x ( ), position.y ( ), facing, drop );
 
+     insert_enemy_into_grid ( enemies.live_size ( ) - 1 );
+
      return true;
 }
 
@@ -938,11 +1151,14 @@ Bool State::spawn_pickup ( const Vector& position, Pickup::Type type )
      Auto* pickup = pickups.spawn ( position );
 
      if ( !pickup ) {
+          warn_pool_full ( pickups, "pickup" );
           return false;
      }
 
      pickup->type = type;
 
+     insert_pickup_into_grid ( pickups.live_size ( ) - 1 );
+
      LOG_DEBUG ( "Spawn pickup %s at %f, %f\n", Pickup::c_names [ type ], position.x ( ), position.y ( ) );
 
      return true;
@@ -956,6 +1172,7 @@ bool State::spawn_projectile ( Projectile::Type type, const Vector& position, Di
      Auto* projectile = projectiles.spawn ( position + offset );
 
      if ( !projectile ) {
+          warn_pool_full ( projectiles, "projectile" );
           return false;
      }
 
@@ -970,7 +1187,7 @@ bool State::spawn_projectile ( Projectile::Type type, const Vector& position, Di
      Auto* emitter = emitters.spawn ( position );
 
      if ( emitter ) {
-          emitter->setup_to_track_entity ( arrow, Projectile::collision_points [ facing ],
+          emitter->setup_to_track_entity ( projectiles.handle ( arrow ), arrow->position, Projectile::collision_points [ facing ],
                                            SDL_MapRGB ( &back_buffer_format, 255, 255, 255 ),
                                            0.0f, 0.0f, 0.5f, 0.5f, 0.1f, 0.1f, 1, 2 );
      }
@@ -984,6 +1201,7 @@ Bool State::spawn_bomb ( const Vector& position )
      Auto* bomb = bombs.spawn ( position );
 
      if ( !bomb ) {
+          warn_pool_full ( bombs, "bomb" );
           return false;
      }
 
@@ -995,9 +1213,11 @@ Bool State::spawn_bomb ( const Vector& position )
 
      if ( emitter ) {
           Vector offset { Map::c_tile_dimension_in_meters * 0.5f, Map::c_tile_dimension_in_meters };
-          emitter->setup_to_track_entity ( bomb, offset,
+          emitter->setup_to_track_entity ( bombs.handle ( bomb ), bomb->position, offset,
                                            SDL_MapRGB ( &back_buffer_format, 255, 255, 0 ),
                                            0.785f, 2.356f, 1.0f, 1.0f, 0.5f, 0.5f, 1, 10 );
+     } else {
+          warn_pool_full ( emitters, "emitter" );
      }
 
      return true;
@@ -1025,7 +1245,7 @@ Void State::start_game ( GameMemory& game_memory )
 
      player.life_state = Entity::LifeState::alive;
 
-     change_map ( settings->map_index, false );
+     change_map ( game_memory, settings->map_index, false );
 }
 
 Bool State::load_region ( GameMemory& game_memory )
@@ -1037,17 +1257,10 @@ Bool State::load_region ( GameMemory& game_memory )
           return false;
      }
 
-     // load diplay surfaces
-     if ( !map_display.load_surfaces ( game_memory,
-                                       region.tilesheet_filepath,
-                                       region.decorsheet_filepath,
-                                       region.lampsheet_filepath ) ) {
-          return false;
-     }
+     map.set_lamp_palette ( region.lamp_colors );
 
-     interactives_display.unload_surfaces ( );
-     if ( !interactives_display.load_surfaces  ( game_memory, region.exitsheet_filepath,
-                                                 region.destructablesheet_filepath ) ) {
+     // load diplay surfaces
+     if ( !load_region_sheets ( game_memory, false ) ) {
           return false;
      }
 
@@ -1076,8 +1289,10 @@ Void State::persist_map ( )
           }
      }
 
-     // persist map enemies
-     for ( Uint32 c = 0; c < enemies.max ( ); ++c ) {
+     // persist map enemies, spawns fill the first slots in order and the map only keeps that many
+     Uint32 persisted_count = enemies.max ( ) < Map::c_max_enemy_spawns ? enemies.max ( ) : Map::c_max_enemy_spawns;
+
+     for ( Uint32 c = 0; c < persisted_count; ++c ) {
           Auto& enemy = enemies [ c ];
 
           map.persist_enemy ( enemy, c );
@@ -1116,6 +1331,7 @@ Void State::player_death ( )
 
      setup_emitters_from_map_lamps ( );
      spawn_map_enemies ( );
+     build_spatial_grids ( );
 }
 
 Bool State::check_player_block_projectile ( Projectile& projectile )
@@ -1130,7 +1346,7 @@ Bool State::check_player_block_projectile ( Projectile& projectile )
                projectile.alliance = Projectile::Alliance::good;
                break;
           case Projectile::arrow:
-               projectile.track_entity.entity = &player;
+               projectile.track_entity.entity = player_handle ( );
                projectile.track_entity.offset = projectile.position - player.position;
                projectile.stuck_watch.reset ( Projectile::c_stuck_time );
                break;
@@ -1174,13 +1390,15 @@ Void State::enemy_death ( const Enemy& enemy )
                                         SDL_MapRGB ( &back_buffer_format, 255, 0, 0 ),
                                         0.0f, 6.28f, 0.3f, 0.7f, 0.25f, explosion_size,
                                         Emitter::c_max_particles, 0 );
+     } else {
+          warn_pool_full ( emitters, "emitter" );
      }
 
      // TODO: track entity count so we don't have to do this linear check
      bool all_dead = true;
 
-     for ( Uint8 i = 0; i < enemies.max ( ); ++i ) {
-          if ( enemies [ i ].is_alive ( ) && enemies [ i ].type != Enemy::Type::spike ) {
+     for ( Uint32 i = 0; i < enemies.live_size ( ); ++i ) {
+          if ( enemies.live ( i ).is_alive ( ) && enemies.live ( i ).type != Enemy::Type::spike ) {
                all_dead = false;
                break;
           }
@@ -1208,6 +1426,7 @@ Void State::setup_emitters_from_map_lamps ( )
           Auto* emitter = emitters.spawn ( position );
 
           if ( !emitter ) {
+               warn_pool_full ( emitters, "emitter" );
                break;
           }
 
@@ -1275,6 +1494,8 @@ Void State::damage_character ( Character& character, Int32 amount, Direction dir
 
 Void State::update_player ( GameMemory& game_memory, float time_delta )
 {
+     PROFILE_ZONE ( "update_player" );
+
      if ( direction_keys [ Direction::up ] ) {
           player.walk ( Direction::up );
      }
@@ -1335,7 +1556,7 @@ Void State::update_player ( GameMemory& game_memory, float time_delta )
           }
      }
 
-     player.update ( time_delta, map, interactives );
+     player.update ( time_delta, map, interactives, settings->merged_walls );
 
      tick_character_element ( player );
 
@@ -1397,9 +1618,9 @@ Void State::update_player ( GameMemory& game_memory, float time_delta )
                          return;
                     }
 
-                    change_map ( map_index, false );
+                    change_map ( game_memory, map_index, false );
                } else {
-                    change_map ( map_index );
+                    change_map ( game_memory, map_index );
                }
 
                player.set_collision_center ( new_position.x ( ), new_position.y ( ) );
@@ -1422,7 +1643,7 @@ Void State::update_player ( GameMemory& game_memory, float time_delta )
                                     Map::location_to_vector ( border_exit_bottom_left );
                Auto new_player_pos = Map::location_to_vector ( map_bottom_left ) + player_offset;
 
-               change_map ( map_index );
+               change_map ( game_memory, map_index );
 
                player.set_collision_center ( new_player_pos.x ( ), new_player_pos.y ( ) );
 
@@ -1507,103 +1728,175 @@ Void State::update_player ( GameMemory& game_memory, float time_delta )
 #endif
 }
 
-Void State::update_enemies ( float time_delta )
+Void State::think_enemies ( float time_delta )
 {
-     Vector player_center = player.collision_center ( );
+     // bucket the live enemies by type so each think routine runs over its whole group in one loop,
+     // within a group they keep their live list order
+     Enemy** grouped = enemy_order;
+     Uint32 group_starts [ Enemy::Type::count + 1 ] = { };
 
-     for ( Uint32 i = 0; i < enemies.max ( ); ++i ) {
-          Auto& enemy = enemies [ i ];
+     for ( Uint32 i = 0; i < enemies.live_size ( ); ++i ) {
+          Auto& enemy = enemies.live ( i );
 
-          if ( enemy.is_dead ( ) ) {
-               continue;
+          if ( !enemy.is_dead ( ) && enemy.type < Enemy::Type::count ) {
+               group_starts [ enemy.type + 1 ]++;
           }
+     }
 
-          Vector enemy_center = enemy.collision_center ( );
+     for ( Int32 t = 0; t < Enemy::Type::count; ++t ) {
+          group_starts [ t + 1 ] += group_starts [ t ];
+     }
 
-#ifdef DEBUG
-          if ( enemy_think ) {
-               enemy.think ( enemies.entities, enemies.max ( ), player, random, time_delta );
+     Uint32 group_ends [ Enemy::Type::count ];
+
+     for ( Int32 t = 0; t < Enemy::Type::count; ++t ) {
+          group_ends [ t ] = group_starts [ t ];
+     }
+
+     for ( Uint32 i = 0; i < enemies.live_size ( ); ++i ) {
+          Auto& enemy = enemies.live ( i );
+
+          if ( !enemy.is_dead ( ) && enemy.type < Enemy::Type::count ) {
+               grouped [ group_ends [ enemy.type ]++ ] = &enemy;
           }
+     }
+
+     for ( Int32 t = 0; t < Enemy::Type::count; ++t ) {
+          Uint32 count = group_ends [ t ] - group_starts [ t ];
+
+          if ( count ) {
+               Enemy::think_group ( static_cast<Enemy::Type>( t ), grouped + group_starts [ t ], count,
+                                    enemies.entities, enemies.max ( ), player, random, time_delta );
+          }
+     }
+}
+
+Void State::update_enemies ( float time_delta )
+{
+     PROFILE_ZONE ( "update_enemies" );
+
+     Vector player_center = player.collision_center ( );
+
+#ifdef DEBUG
+     if ( enemy_think ) {
+          think_enemies ( time_delta );
+     }
 #else
-          enemy.think ( enemies.entities, enemies.max ( ), player, random, time_delta );
+     think_enemies ( time_delta );
 #endif
 
-          enemy.update ( time_delta, map, interactives );
+     // work out every enemy's acceleration first so they integrate a batch at a time, the ones
+     // updated are the ones alive now, not any spawned or killed while updating
+     Uint32 update_count = 0;
 
-          if ( enemy.type == Enemy::Type::fairy &&
-               enemy.fairy_state.heal_timer.expired ( ) ) {
-               heal_enemies_in_range_of_fairy ( enemy.position );
-          }
+     for ( Uint32 i = 0; i < enemies.live_size ( ); ++i ) {
+          Auto& enemy = enemies.live ( i );
 
-          // check if the enemy has died after updating
           if ( enemy.is_dead ( ) ) {
-               enemy_death ( enemy );
                continue;
           }
 
-          // spawn a projectile if the goo is shooting
-          if ( enemy.type == Enemy::Type::goo &&
-               enemy.goo_state.state == Enemy::GooState::State::shooting ) {
-               spawn_projectile ( Projectile::Type::goo, enemy.position, enemy.facing,
-                                  Projectile::Alliance::evil );
-          } else if ( enemy.type == Enemy::Type::ice_wizard &&
-                      enemy.ice_wizard_state.state == Enemy::IceWizardState::State::attack ) {
-               spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::left,
-                                  Projectile::Alliance::evil );
-               spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::up,
-                                  Projectile::Alliance::evil );
-               spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::right,
-                                  Projectile::Alliance::evil );
-               spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::down,
-                                  Projectile::Alliance::evil );
-          }
-
-          tick_character_element ( enemy );
-
-          // check collision between player and enemy
-          if ( !player.is_blinking ( ) && player.is_alive ( ) &&
-               !enemy.is_blinking ( ) && player.collides_with ( enemy ) ) {
-               Direction damage_dir = direction_between ( enemy_center, player_center, random );
-
-               // check if player blocked the attack
-               if ( player.is_blocking ( ) &&
-                    damage_dir == opposite_direction ( player.facing ) ) {
-                    damage_character ( enemy, c_block_damage, opposite_direction ( damage_dir ) ) ;
-                    spawn_pickup ( enemy.position, enemy.drop );
-                    enemy.drop = Pickup::Type::none;
-               } else {
-                    damage_character ( player, c_enemy_damage, damage_dir );
-                    sound.play_effect ( Sound::Effect::player_damaged );
-                    enemy.hit_player = true;
-               }
+          enemy.begin_update ( time_delta );
+          enemy_order [ update_count++ ] = &enemy;
+     }
+
+     KinematicsBatch<c_kinematics_batch_size> kinematics;
+
+     for ( Uint32 b = 0; b < update_count; b += c_kinematics_batch_size ) {
+          kinematics.clear ( );
+
+          for ( Uint32 i = b; i < update_count && kinematics.count < c_kinematics_batch_size; ++i ) {
+               kinematics.add ( *enemy_order [ i ] );
+          }
+
+          kinematics.integrate ( time_delta );
+
+          for ( Uint32 k = 0; k < kinematics.count; ++k ) {
+               update_enemy ( static_cast<Enemy&>( *kinematics.characters [ k ] ), kinematics.finish ( k ),
+                              player_center, time_delta );
+          }
+     }
+}
+
+Void State::update_enemy ( Enemy& enemy, const Vector& change, const Vector& player_center, float time_delta )
+{
+     Vector enemy_center = enemy.collision_center ( );
+
+     enemy.finish_update ( time_delta, change, map, interactives, settings->merged_walls );
+
+     if ( enemy.type == Enemy::Type::fairy &&
+          enemy.fairy_state.heal_timer.expired ( ) ) {
+          heal_enemies_in_range_of_fairy ( enemy.position );
+     }
+
+     // check if the enemy has died after updating
+     if ( enemy.is_dead ( ) ) {
+          enemy_death ( enemy );
+          return;
+     }
+
+     // spawn a projectile if the goo is shooting
+     if ( enemy.type == Enemy::Type::goo &&
+          enemy.goo_state.state == Enemy::GooState::State::shooting ) {
+          spawn_projectile ( Projectile::Type::goo, enemy.position, enemy.facing,
+                             Projectile::Alliance::evil );
+     } else if ( enemy.type == Enemy::Type::ice_wizard &&
+                 enemy.ice_wizard_state.state == Enemy::IceWizardState::State::attack ) {
+          spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::left,
+                             Projectile::Alliance::evil );
+          spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::up,
+                             Projectile::Alliance::evil );
+          spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::right,
+                             Projectile::Alliance::evil );
+          spawn_projectile ( Projectile::Type::ice, enemy.position, Direction::down,
+                             Projectile::Alliance::evil );
+     }
+
+     tick_character_element ( enemy );
+
+     // check collision between player and enemy
+     if ( !player.is_blinking ( ) && player.is_alive ( ) &&
+          !enemy.is_blinking ( ) && player.collides_with ( enemy ) ) {
+          Direction damage_dir = direction_between ( enemy_center, player_center, random );
+
+          // check if player blocked the attack
+          if ( player.is_blocking ( ) &&
+               damage_dir == opposite_direction ( player.facing ) ) {
+               damage_character ( enemy, c_block_damage, opposite_direction ( damage_dir ) ) ;
+               spawn_pickup ( enemy.position, enemy.drop );
+               enemy.drop = Pickup::Type::none;
+          } else {
+               damage_character ( player, c_enemy_damage, damage_dir );
+               sound.play_effect ( Sound::Effect::player_damaged );
+               enemy.hit_player = true;
+          }
 
 #ifdef DEBUG
-               if ( invincible ) {
-                    player.health = player.max_health;
-               }
+          if ( invincible ) {
+               player.health = player.max_health;
+          }
 #endif
 
-               // transfer element to player
-               player.effect_with_element ( enemy.effected_by_element );
-          }
+          // transfer element to player
+          player.effect_with_element ( enemy.effected_by_element );
+     }
 
-          // check if player's attack hits enemy
-          if ( player.is_attacking ( ) && !enemy.is_blinking ( ) &&
-               player.attack_collides_with ( enemy ) ) {
+     // check if player's attack hits enemy
+     if ( player.is_attacking ( ) && !enemy.is_blinking ( ) &&
+          player.attack_collides_with ( enemy ) ) {
 
-               if ( enemy.type == Enemy::Type::knight &&
-                    player.facing == opposite_direction ( enemy.facing ) ) {
-                    Direction damage_dir = direction_between ( player_center, enemy_center, random );
-                    damage_character ( enemy, 0, damage_dir );
-                    // TODO: No damage sound effect
-               } else if ( enemy.type == Enemy::Type::spike ) {
-                    // pass, this dude's invincible
-                    // TODO: No damage sound effect
-               } else {
-                    Direction damage_dir = direction_between ( player_center, enemy_center, random );
-                    damage_character ( enemy, c_attack_damage, damage_dir );
-                    sound.play_effect ( Sound::Effect::player_damaged );
-               }
+          if ( enemy.type == Enemy::Type::knight &&
+               player.facing == opposite_direction ( enemy.facing ) ) {
+               Direction damage_dir = direction_between ( player_center, enemy_center, random );
+               damage_character ( enemy, 0, damage_dir );
+               // TODO: No damage sound effect
+          } else if ( enemy.type == Enemy::Type::spike ) {
+               // pass, this dude's invincible
+               // TODO: No damage sound effect
+          } else {
+               Direction damage_dir = direction_between ( player_center, enemy_center, random );
+               damage_character ( enemy, c_attack_damage, damage_dir );
+               sound.play_effect ( Sound::Effect::player_damaged );
           }
      }
 }
@@ -1616,14 +1909,20 @@ Void State::push_interactive ( const Location& tile, Direction dir, const Map& m
 
      Bool enemy_on_tile = false;
      Auto dest = adjacent_tile ( tile, dir );
+     SpatialGrid::Found found;
+
+     enemy_grid.query ( pixels_to_meters ( dest.x * Map::c_tile_dimension_in_pixels ),
+                        pixels_to_meters ( dest.y * Map::c_tile_dimension_in_pixels ),
+                        Map::c_tile_dimension_in_meters, Map::c_tile_dimension_in_meters, found );
+
+     for ( Uint32 i = 0; i < found.count; ++i ) {
+          Auto& enemy = enemies.live ( found.indices [ i ] );
 
-     for ( Uint8 i = 0; i < enemies.max ( ); ++i ) {
-          if ( enemies [ i ].is_dead ( ) ) {
+          if ( enemy.is_dead ( ) ) {
                continue;
           }
 
-          if ( character_touching_tile ( enemies [ i ], dest ) &&
-               !enemies [ i ].flies ) {
+          if ( character_touching_tile ( enemy, dest ) && !enemy.flies ) {
                enemy_on_tile = true;
                break;
           }
@@ -1655,6 +1954,8 @@ Void State::push_interactive ( const Location& tile, Direction dir, const Map& m
 
 Void State::update_interactives ( float time_delta )
 {
+     PROFILE_ZONE ( "update_interactives" );
+
      Int32 count = map.width ( ) * map.height ( );
 
      for ( Int32 i = 0; i < count; ++i ) {
@@ -1712,6 +2013,10 @@ Void State::update_interactives ( float time_delta )
                interactive.update ( time_delta, interactives );
                break;
           case Interactive::Type::exit:
+               if ( interactive.interactive_exit.changing ( ) ) {
+                    interactives.tile_changed ( i );
+               }
+
                interactive.update ( time_delta, interactives );
                break;
           case Interactive::Type::turret:
@@ -1757,14 +2062,17 @@ Void State::update_interactives ( float time_delta )
 
 Void State::update_projectiles ( float time_delta )
 {
-     for ( Uint32 i = 0; i < projectiles.max ( ); ++i ) {
-          Auto& projectile = projectiles [ i ];
+     PROFILE_ZONE ( "update_projectiles" );
+
+     for ( Uint32 i = 0; i < projectiles.live_size ( ); ++i ) {
+          Auto& projectile = projectiles.live ( i );
 
           if ( projectile.is_dead ( ) ) {
                continue;
           }
 
-          projectile.update ( time_delta, map, interactives );
+          projectile.update ( time_delta, map, interactives,
+                              resolve_entity ( projectile.track_entity.entity ) );
 
           if ( !projectile.stuck_watch.expired ( ) ) {
                continue;
@@ -1776,21 +2084,8 @@ Void State::update_projectiles ( float time_delta )
           default:
                break;
           case Projectile::Alliance::good:
-               for ( Uint32 c = 0; c < enemies.max ( ); ++c ) {
-                    Auto& enemy = enemies [ c ];
-
-                    if ( enemy.is_dead ( ) || enemy.is_blinking ( ) ) {
-                         continue;
-                    }
-
-                    if ( point_inside_rect ( projectile_collision_point.x ( ),
-                                             projectile_collision_point.y ( ),
-                                             enemy.collision_x ( ), enemy.collision_y ( ),
-                                             enemy.collision_x ( ) + enemy.collision_width ( ),
-                                             enemy.collision_y ( ) + enemy.collision_height ( ) ) ) {
-                         projectile.hit_character ( enemy );
-                         break;
-                    }
+               if ( Auto* enemy = enemy_hit_by_point ( projectile_collision_point ) ) {
+                    projectile.hit_character ( *enemy, enemies.handle ( enemy ) );
                }
                break;
          case Projectile::Alliance::evil:
@@ -1801,27 +2096,14 @@ Void State::update_projectiles ( float time_delta )
                                         player.collision_x ( ) + player.collision_width ( ),
                                         player.collision_y ( ) + player.collision_height ( ) ) ) {
                     if ( !check_player_block_projectile ( projectile ) ) {
-                         projectile.hit_character ( player );
+                         projectile.hit_character ( player, player_handle ( ) );
                          sound.play_effect ( Sound::Effect::player_damaged );
                     }
                }
                break;
          case Projectile::Alliance::neutral:
-               for ( Uint32 c = 0; c < enemies.max ( ); ++c ) {
-                    Auto& enemy = enemies [ c ];
-
-                    if ( enemy.is_dead ( ) || enemy.is_blinking ( ) ) {
-                         continue;
-                    }
-
-                    if ( point_inside_rect ( projectile_collision_point.x ( ),
-                                             projectile_collision_point.y ( ),
-                                             enemy.collision_x ( ), enemy.collision_y ( ),
-                                             enemy.collision_x ( ) + enemy.collision_width ( ),
-                                             enemy.collision_y ( ) + enemy.collision_height ( ) ) ) {
-                         projectile.hit_character ( enemy );
-                         break;
-                    }
+               if ( Auto* enemy = enemy_hit_by_point ( projectile_collision_point ) ) {
+                    projectile.hit_character ( *enemy, enemies.handle ( enemy ) );
                }
 
                if ( !player.is_blinking ( ) &&
@@ -1831,7 +2113,7 @@ Void State::update_projectiles ( float time_delta )
                                         player.collision_x ( ) + player.collision_width ( ),
                                         player.collision_y ( ) + player.collision_height ( ) ) ) {
                     if ( !check_player_block_projectile ( projectile ) ) {
-                         projectile.hit_character ( player );
+                         projectile.hit_character ( player, player_handle ( ) );
                          sound.play_effect ( Sound::Effect::player_damaged );
                     }
                }
@@ -1841,10 +2123,55 @@ Void State::update_projectiles ( float time_delta )
      }
 }
 
+Enemy* State::enemy_hit_by_point ( const Vector& point )
+{
+     static const Uint32 c_batch_size = 32;
+
+     SpatialGrid::Found found;
+     CollisionBatch<c_batch_size> batch;
+     Uint32 batch_indices [ c_batch_size ];
+     Bool hits [ c_batch_size ];
+
+     enemy_grid.query ( point.x ( ), point.y ( ), 0.0f, 0.0f, found );
+
+     Uint32 i = 0;
+
+     while ( i < found.count ) {
+          batch.clear ( );
+
+          for ( ; i < found.count && batch.count < c_batch_size; ++i ) {
+               Auto& enemy = enemies.live ( found.indices [ i ] );
+
+               if ( enemy.is_dead ( ) || enemy.is_blinking ( ) ) {
+                    continue;
+               }
+
+               batch_indices [ batch.count ] = found.indices [ i ];
+               batch.add ( enemy.collision_x ( ), enemy.collision_y ( ),
+                           enemy.collision_width ( ), enemy.collision_height ( ) );
+          }
+
+          if ( !batch.test ( point.x ( ), point.y ( ), 0.0f, 0.0f, hits ) ) {
+               continue;
+          }
+
+          // candidates are in live order, the first hit is the one a linear scan would find
+          for ( Uint32 b = 0; b < batch.count; ++b ) {
+               if ( hits [ b ] ) {
+                    return &enemies.live ( batch_indices [ b ] );
+               }
+          }
+     }
+
+     return nullptr;
+}
+
 Void State::update_bombs ( float time_delta )
 {
-     for ( Uint32 i = 0; i < bombs.max ( ); ++i ) {
-          Auto& bomb = bombs [ i ];
+     PROFILE_ZONE ( "update_bombs" );
+
+     for ( Uint32 i = 0; i < bombs.live_size ( ); ++i ) {
+          Auto& bomb = bombs.live ( i );
 
           if ( bomb.is_dead ( ) ) {
                continue;
@@ -1867,8 +2194,14 @@ Void State::update_bombs ( float time_delta )
 
           if ( bomb.life_state == Entity::LifeState::dying ) {
                // damage nearby enemies
-               for ( Uint32 c = 0; c < enemies.max ( ); ++c ) {
-                    Auto& enemy = enemies [ c ];
+               Real32 radius = Bomb::c_explode_radius;
+               SpatialGrid::Found found;
+
+               enemy_grid.query ( bomb.position.x ( ) - radius, bomb.position.y ( ) - radius,
+                                  radius * 2.0f, radius * 2.0f, found );
+
+               for ( Uint32 c = 0; c < found.count; ++c ) {
+                    Auto& enemy = enemies.live ( found.indices [ c ] );
 
                     if ( enemy.is_dead ( ) ) {
                          continue;
@@ -1914,6 +2247,8 @@ Void State::update_bombs ( float time_delta )
                                                   SDL_MapRGB ( &back_buffer_format, 200, 200, 200 ),
                                                   0.0f, 6.28f, 0.5f, 0.5f, 6.0f, 6.0f,
                                                   Emitter::c_max_particles, 0 );
+               } else {
+                    warn_pool_full ( emitters, "emitter" );
                }
 
                sound.play_effect ( Sound::Effect::bomb_exploded );
@@ -1923,8 +2258,32 @@ Void State::update_bombs ( float time_delta )
 
 Void State::update_pickups ( float time_delta )
 {
-     for ( Uint32 i = 0; i < pickups.max ( ); ++i ) {
-          Pickup& pickup = pickups [ i ];
+     PROFILE_ZONE ( "update_pickups" );
+
+     Real32 min_x = player.collision_x ( );
+     Real32 min_y = player.collision_y ( );
+     Real32 max_x = min_x + player.collision_width ( );
+     Real32 max_y = min_y + player.collision_height ( );
+
+     // the attack can pick things up too, search around both
+     if ( player.is_attacking ( ) ) {
+          Real32 attack_min_x = player.attack_x ( );
+          Real32 attack_min_y = player.attack_y ( );
+          Real32 attack_max_x = attack_min_x + player.attack_width ( );
+          Real32 attack_max_y = attack_min_y + player.attack_height ( );
+
+          min_x = attack_min_x < min_x ? attack_min_x : min_x;
+          min_y = attack_min_y < min_y ? attack_min_y : min_y;
+          max_x = attack_max_x > max_x ? attack_max_x : max_x;
+          max_y = attack_max_y > max_y ? attack_max_y : max_y;
+     }
+
+     SpatialGrid::Found found;
+
+     pickup_grid.query ( min_x, min_y, max_x - min_x, max_y - min_y, found );
+
+     for ( Uint32 i = 0; i < found.count; ++i ) {
+          Pickup& pickup = pickups.live ( found.indices [ i ] );
 
           if ( pickup.is_dead ( ) ) {
                continue;
@@ -1984,50 +2343,197 @@ Void State::update_pickups ( float time_delta )
 
 Void State::update_emitters ( float time_delta )
 {
-     for ( Uint32 i = 0; i < emitters.max ( ); ++i ) {
-          Auto& emitter = emitters [ i ];
+     PROFILE_ZONE ( "update_emitters" );
+
+     for ( Uint32 i = 0; i < emitters.live_size ( ); ++i ) {
+          Auto& emitter = emitters.live ( i );
 
           if ( emitter.is_dead ( ) ) {
                continue;
           }
 
-          emitter.update ( time_delta, random );
+          emitter.update ( time_delta, random, resolve_entity ( emitter.track_entity.entity ) );
      }
 }
 
 
 Void State::update_light ( )
 {
-     map.reset_light ( );
+     PROFILE_ZONE ( "update_light" );
+
+     map.begin_light ( );
 
      interactives.contribute_light ( map );
 
-     // projectiles on fire contribute light
-     for ( Uint32 i = 0; i < projectiles.max ( ); ++i ) {
-          Auto& projectile = projectiles [ i ];
+     // projectiles on fire contribute light, icy ones tint what is around them without lighting it
+     for ( Uint32 i = 0; i < projectiles.live_size ( ); ++i ) {
+          Auto& projectile = projectiles.live ( i );
 
           if ( projectile.is_dead ( ) ) {
                continue;
           }
 
-          if ( projectile.effected_by_element == Element::fire ) {
+          if ( projectile.effected_by_element == Element::fire ||
+               projectile.effected_by_element == Element::ice ) {
                Vector collision_position ( projectile.position.x ( ) +
                                            Projectile::collision_points [ projectile.facing ].x ( ),
                                            projectile.position.y ( ) +
                                            Projectile::collision_points [ projectile.facing ].y ( ) );
                Location collision_tile = Map::vector_to_location ( collision_position );
-               map.illuminate ( collision_tile, LightDetector::c_bryte_value - 1 );
+               map.add_light ( collision_tile, LightDetector::c_bryte_value - 1,
+                               projectile.effected_by_element == Element::fire ? Map::c_fire_light :
+                                                                                 Map::c_ice_light );
           }
      }
 
-     // give interactives the light values on their respective tiles
+     map.end_light ( );
+
+     // give interactives the light values on their respective tiles, uncovered light detectors
+     // are the only ones that react so leave the rest alone
      for ( Location tile; tile.y < interactives.height ( ); ++tile.y ) {
           for ( tile.x = 0; tile.x < interactives.width ( ); ++tile.x ) {
-               interactives.light ( tile, map.get_tile_location_light ( tile ) );
+               const Auto& interactive = interactives.cget_from_tile ( tile );
+
+               if ( interactive.type == Interactive::Type::none &&
+                    interactive.underneath.type == UnderneathInteractive::Type::light_detector ) {
+                    interactives.light ( tile, map.get_tile_location_light ( tile ) );
+               }
           }
      }
 }
 
+Void State::update_displays ( )
+{
+     PROFILE_ZONE ( "update_displays" );
+
+     // NOTE: animations advance with the simulation so they don't speed up at higher render rates
+     map_display.tick ( );
+     interactives_display.tick ( );
+     character_display.tick ( );
+     pickup_display.tick ( );
+     projectile_display.tick ( );
+}
+
+Void State::reap_entities ( )
+{
+     enemies.reap ( );
+     pickups.reap ( );
+     projectiles.reap ( );
+     bombs.reap ( );
+     emitters.reap ( );
+}
+
+Void State::build_spatial_grids ( )
+{
+     enemy_grid.clear ( map.width ( ), map.height ( ) );
+     pickup_grid.clear ( map.width ( ), map.height ( ) );
+
+     for ( Uint32 i = 0; i < enemies.live_size ( ); ++i ) {
+          insert_enemy_into_grid ( i );
+     }
+
+     for ( Uint32 i = 0; i < pickups.live_size ( ); ++i ) {
+          insert_pickup_into_grid ( i );
+     }
+}
+
+Void State::insert_enemy_into_grid ( Uint32 live_index )
+{
+     Auto& enemy = enemies.live ( live_index );
+
+     if ( enemy.is_dead ( ) ) {
+          return;
+     }
+
+     // queries test both the sprite and collision bounds, cover them both
+     Real32 min_x = enemy.position.x ( ) < enemy.collision_x ( ) ? enemy.position.x ( ) : enemy.collision_x ( );
+     Real32 min_y = enemy.position.y ( ) < enemy.collision_y ( ) ? enemy.position.y ( ) : enemy.collision_y ( );
+     Real32 max_x = enemy.position.x ( ) + enemy.width ( );
+     Real32 max_y = enemy.position.y ( ) + enemy.height ( );
+
+     if ( enemy.collision_x ( ) + enemy.collision_width ( ) > max_x ) {
+          max_x = enemy.collision_x ( ) + enemy.collision_width ( );
+     }
+
+     if ( enemy.collision_y ( ) + enemy.collision_height ( ) > max_y ) {
+          max_y = enemy.collision_y ( ) + enemy.collision_height ( );
+     }
+
+     enemy_grid.insert ( live_index, min_x, min_y, max_x - min_x, max_y - min_y );
+}
+
+Void State::insert_pickup_into_grid ( Uint32 live_index )
+{
+     Auto& pickup = pickups.live ( live_index );
+
+     if ( pickup.is_dead ( ) ) {
+          return;
+     }
+
+     pickup_grid.insert ( live_index, pickup.position.x ( ), pickup.position.y ( ),
+                          Pickup::c_dimension_in_meters, Pickup::c_dimension_in_meters );
+}
+
+Entity* State::resolve_entity ( const EntityHandle& handle )
+{
+     switch ( handle.pool ) {
+     default:
+          ASSERT ( 0 );
+          break;
+     case EntityHandle::Pool::none:
+          break;
+     case EntityHandle::Pool::player:
+          return &player;
+     case EntityHandle::Pool::enemies:
+          return enemies.resolve ( handle );
+     case EntityHandle::Pool::pickups:
+          return pickups.resolve ( handle );
+     case EntityHandle::Pool::projectiles:
+          return projectiles.resolve ( handle );
+     case EntityHandle::Pool::bombs:
+          return bombs.resolve ( handle );
+     case EntityHandle::Pool::emitters:
+          return emitters.resolve ( handle );
+     }
+
+     return nullptr;
+}
+
+EntityHandle State::player_handle ( ) const
+{
+     return EntityHandle { EntityHandle::Pool::player, 0, 0 };
+}
+
+Void State::store_previous_positions ( )
+{
+     player.previous_position = player.position;
+
+     enemies.store_previous_positions ( );
+     pickups.store_previous_positions ( );
+     projectiles.store_previous_positions ( );
+     bombs.store_previous_positions ( );
+}
+
+Void State::begin_interpolation ( Real32 interpolation )
+{
+     player.begin_interpolation ( interpolation );
+
+     enemies.begin_interpolation ( interpolation );
+     pickups.begin_interpolation ( interpolation );
+     projectiles.begin_interpolation ( interpolation );
+     bombs.begin_interpolation ( interpolation );
+}
+
+Void State::end_interpolation ( )
+{
+     player.end_interpolation ( );
+
+     enemies.end_interpolation ( );
+     pickups.end_interpolation ( );
+     projectiles.end_interpolation ( );
+     bombs.end_interpolation ( );
+}
+
 Void State::enqueue_pickup ( Pickup::Type type )
 {
      for( Int32 i = 0; i < c_pickup_queue_size; ++i ) {
@@ -2051,8 +2557,13 @@ Void State::dequeue_pickup ( )
 
 Void State::heal_enemies_in_range_of_fairy ( const Vector& position )
 {
-     for ( Uint32 i = 0; i < enemies.max ( ); ++i ) {
-          Auto& enemy = enemies [ i ];
+     Real32 radius = Enemy::FairyState::c_heal_radius;
+     SpatialGrid::Found found;
+
+     enemy_grid.query ( position.x ( ) - radius, position.y ( ) - radius, radius * 2.0f, radius * 2.0f, found );
+
+     for ( Uint32 i = 0; i < found.count; ++i ) {
+          Auto& enemy = enemies.live ( found.indices [ i ] );
 
           if ( enemy.is_dead ( ) || enemy.type == Enemy::Type::fairy ) {
                continue;
@@ -2065,7 +2576,51 @@ Void State::heal_enemies_in_range_of_fairy ( const Vector& position )
      }
 }
 
-Void State::change_map ( Int32 map_index, Bool persist )
+Bool State::random_open_position ( Vector* position )
+{
+     // give up after a few misses rather than spin on a map that is mostly solid
+     static const Int32 c_max_attempts = 16;
+
+     for ( Int32 i = 0; i < c_max_attempts; ++i ) {
+          Location tile ( static_cast<Int32>( random.generate ( 0, map.width ( ) ) ),
+                          static_cast<Int32>( random.generate ( 0, map.height ( ) ) ) );
+
+          if ( map.get_tile_location_solid ( tile ) ||
+               interactives.cget_from_tile ( tile ).type != Interactive::Type::none ) {
+               continue;
+          }
+
+          *position = Map::location_to_vector ( tile );
+          return true;
+     }
+
+     return false;
+}
+
+Void State::fill_stress_pools ( )
+{
+     // the pools have just been reaped so everything in the live lists is alive
+     Vector position;
+
+     while ( enemies.live_size ( ) < enemies.capacity && random_open_position ( &position ) ) {
+          spawn_enemy ( position, static_cast<Uint8>( random.generate ( 0, Enemy::Type::count ) ),
+                        static_cast<Direction>( random.generate ( 0, Direction::count ) ), Pickup::Type::none );
+     }
+
+     while ( projectiles.live_size ( ) < projectiles.capacity && enemies.live_size ( ) ) {
+          Auto& enemy = enemies.live ( random.generate ( 0, enemies.live_size ( ) ) );
+
+          spawn_projectile ( static_cast<Projectile::Type>( random.generate ( Projectile::Type::arrow,
+                                                                              Projectile::Type::ice + 1 ) ),
+                             enemy.position, static_cast<Direction>( random.generate ( 0, Direction::count ) ),
+                             Projectile::Alliance::evil );
+     }
+
+     // being swarmed would kill the player and clear the pools every few frames
+     player.health = player.max_health;
+}
+
+Void State::change_map ( GameMemory& game_memory, Int32 map_index, Bool persist )
 {
      LOG_DEBUG ( "Changing map to %d\n", map_index );
 
@@ -2084,6 +2639,7 @@ Void State::change_map ( Int32 map_index, Bool persist )
      emitters.clear ( );
 
      spawn_map_enemies ( );
+     build_spatial_grids ( );
 
      setup_emitters_from_map_lamps ( );
 
@@ -2146,6 +2702,8 @@ Bool State::change_region ( GameMemory& game_memory, Int32 region_index )
           return false;
      }
 
+     map.set_lamp_palette ( region.lamp_colors );
+
      // load the new master list and it's corresponding persistence if it exists
      if ( !map.load_master_list ( region.map_list_filepath ) ) {
           return false;
@@ -2154,7 +2712,25 @@ Bool State::change_region ( GameMemory& game_memory, Int32 region_index )
      map.load_persistence ( region.name, player.save_slot );
 
      // unload and re-load surfaces
-     map_display.unload_surfaces ( );
+     return load_region_sheets ( game_memory, false );
+}
+
+Bool State::load_region_sheets ( GameMemory& game_memory, Bool restored )
+{
+     // right after game memory is restored State's pointers may be another run's or ones already
+     // freed, only the record can be trusted to free
+     if ( restored ) {
+          if ( g_region_sheets.loaded ) {
+               g_region_sheets.map_display.unload_surfaces ( );
+               g_region_sheets.interactives_display.unload_surfaces ( );
+          }
+     } else {
+          map_display.unload_surfaces ( );
+          interactives_display.unload_surfaces ( );
+     }
+
+     g_region_sheets.loaded = false;
+
      if ( !map_display.load_surfaces ( game_memory,
                                        region.tilesheet_filepath,
                                        region.decorsheet_filepath,
@@ -2162,12 +2738,16 @@ Bool State::change_region ( GameMemory& game_memory, Int32 region_index )
           return false;
      }
 
-     interactives_display.unload_surfaces ( );
      if ( !interactives_display.load_surfaces  ( game_memory, region.exitsheet_filepath,
                                                  region.destructablesheet_filepath ) ) {
           return false;
      }
 
+     g_region_sheets.map_display = map_display;
+     g_region_sheets.interactives_display = interactives_display;
+     g_region_sheets.region_index = region.current_index;
+     g_region_sheets.loaded = true;
+
      return true;
 }
 
@@ -2203,13 +2783,33 @@ Void State::render_upgrade ( SDL_Surface* back_buffer )
      SDL_BlitSurface ( upgrade_sheet, &src, back_buffer, &dst );
 }
 
+static Void set_active_profiler ( State* state )
+{
+#ifdef PROFILE
+     Profiler::active = &state->profiler;
+#endif
+}
+
 extern "C" Bool game_init ( GameMemory& game_memory, Void* settings )
 {
-     MemoryLocations* memory_locations = GAME_PUSH_MEMORY ( game_memory, MemoryLocations );
-     State* state = GAME_PUSH_MEMORY ( game_memory, State );
+     // the entity pools are sized by the settings, make room for them on top of everything else
+     Uint32 pool_size = State::pool_bytes ( *reinterpret_cast<Settings*>( settings ) );
+
+     if ( !game_memory.partition ( State::c_permanent_arena_size + pool_size ) ) {
+          LOG_ERROR ( "Failed to partition %u bytes of game memory with %u bytes of entity pools\n",
+                      game_memory.size ( ), pool_size );
+          return false;
+     }
+
+     MemoryLocations* memory_locations = GAME_PUSH_ARENA_MEMORY ( game_memory, GameMemory::Arena::permanent,
+                                                                  GameMemory::Tag::state, MemoryLocations );
+     State* state = GAME_PUSH_ARENA_MEMORY ( game_memory, GameMemory::Arena::permanent,
+                                            GameMemory::Tag::state, State );
 
      memory_locations->state = state;
 
+     set_active_profiler ( state );
+
      if ( !state->initialize ( game_memory, reinterpret_cast<Settings*>( settings ) ) ) {
           return false;
      }
@@ -2217,6 +2817,24 @@ extern "C" Bool game_init ( GameMemory& game_memory, Void* settings )
      return true;
 }
 
+extern "C" Bool game_restore ( GameMemory& game_memory, Void* settings )
+{
+     Auto* state = get_state ( game_memory );
+
+     set_active_profiler ( state );
+
+     return state->restore ( game_memory, reinterpret_cast<Settings*>( settings ) );
+}
+
+extern "C" Bool game_resume ( GameMemory& game_memory )
+{
+     Auto* state = get_state ( game_memory );
+
+     set_active_profiler ( state );
+
+     return state->resume ( game_memory );
+}
+
 extern "C" Void game_destroy ( GameMemory& game_memory )
 {
      Auto* state = get_state ( game_memory );
@@ -2228,6 +2846,8 @@ extern "C" Void game_user_input ( GameMemory& game_memory, const GameInput& game
 {
      Auto* state = get_state ( game_memory );
 
+     set_active_profiler ( state );
+
      state->handle_input ( game_memory, game_input );
 }
 
@@ -2235,6 +2855,10 @@ extern "C" Void game_update ( GameMemory& game_memory, Real32 time_delta )
 {
      Auto* state = get_state ( game_memory );
 
+     set_active_profiler ( state );
+
+     PROFILE_ZONE ( "game_update" );
+
      state->update ( game_memory, time_delta );
 }
 
@@ -2325,9 +2949,17 @@ static Void render_hearts ( SDL_Surface* back_buffer, SDL_Surface* heart_sheet,
      }
 }
 
-extern "C" Void game_render ( GameMemory& game_memory, SDL_Surface* back_buffer )
+extern "C" Void game_render ( GameMemory& game_memory, SDL_Surface* back_buffer, Real32 interpolation )
 {
      Auto* state = get_state ( game_memory );
 
-     state->render ( game_memory, back_buffer );
+     set_active_profiler ( state );
+
+     PROFILE_ZONE ( "game_render" );
+
+     state->render ( game_memory, back_buffer, interpolation );
+
+#ifdef PROFILE
+     state->profiler.end_frame ( );
+#endif
 }
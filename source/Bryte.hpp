@@ -19,6 +19,8 @@
 #include "Dialogue.hpp"
 
 #include "EntityManager.hpp"
+#include "SpatialGrid.hpp"
+#include "Collision.hpp"
 
 #include "Random.hpp"
 
@@ -35,8 +37,12 @@
 
 #include "Text.hpp"
 
+#include "Profiler.hpp"
+
 #include <SDL2/SDL.h>
 
+#include <cstring>
+
 namespace bryte
 {
      struct UITextMenu {
@@ -77,8 +83,79 @@ namespace bryte
 
           Int32  player_spawn_tile_x;
           Int32  player_spawn_tile_y;
+
+          // entity pool capacities, their memory is reserved when the game starts
+          Uint32 max_enemies;
+          Uint32 max_pickups;
+          Uint32 max_projectiles;
+          Uint32 max_bombs;
+          Uint32 max_emitters;
+
+          // keeps the enemy and projectile pools full to see how the game holds up
+          Bool   stress;
+
+          // blends the light between tile centers rather than lighting each tile evenly
+          Bool   smooth_light;
+
+          // characters collide against merged walls rather than every solid tile
+          Bool   merged_walls;
+
+          static const Uint32 c_default_max_enemies     = 32;
+          static const Uint32 c_default_max_pickups     = 8;
+          static const Uint32 c_default_max_projectiles = 64;
+          static const Uint32 c_default_max_bombs       = 8;
+          static const Uint32 c_default_max_emitters    = 32;
+
+          static const Uint32 c_stress_max_enemies      = 1024;
+          static const Uint32 c_stress_max_projectiles  = 2048;
+
+          inline Void default_capacities ( );
+
+          // turns stress on and raises the pools it keeps full
+          inline Void enable_stress ( );
+
+          // pool is enemies, pickups, projectiles, bombs or emitters
+          inline Bool set_capacity ( const Char8* pool, Uint32 count );
      };
 
+     inline Void Settings::default_capacities ( )
+     {
+          max_enemies     = c_default_max_enemies;
+          max_pickups     = c_default_max_pickups;
+          max_projectiles = c_default_max_projectiles;
+          max_bombs       = c_default_max_bombs;
+          max_emitters    = c_default_max_emitters;
+
+          stress = false;
+     }
+
+     inline Void Settings::enable_stress ( )
+     {
+          stress = true;
+
+          max_enemies     = c_stress_max_enemies;
+          max_projectiles = c_stress_max_projectiles;
+     }
+
+     inline Bool Settings::set_capacity ( const Char8* pool, Uint32 count )
+     {
+          if ( strcmp ( pool, "enemies" ) == 0 ) {
+               max_enemies = count;
+          } else if ( strcmp ( pool, "pickups" ) == 0 ) {
+               max_pickups = count;
+          } else if ( strcmp ( pool, "projectiles" ) == 0 ) {
+               max_projectiles = count;
+          } else if ( strcmp ( pool, "bombs" ) == 0 ) {
+               max_bombs = count;
+          } else if ( strcmp ( pool, "emitters" ) == 0 ) {
+               max_emitters = count;
+          } else {
+               return false;
+          }
+
+          return true;
+     }
+
      struct State {
      public:
 
@@ -91,13 +168,25 @@ namespace bryte
      public:
 
           Bool initialize ( GameMemory& game_memory, Settings* settings );
+          Bool load_assets ( GameMemory& game_memory );
+          Void unload_assets ( );
+          Bool restore    ( GameMemory& game_memory, Settings* settings );
+          Bool resume     ( GameMemory& game_memory );
           Void destroy    ( );
           Void update ( GameMemory& game_memory, Real32 time_delta );
           Void handle_input ( GameMemory& game_memory, const GameInput& game_input );
-          Void render ( GameMemory& game_memory, SDL_Surface* back_buffer );
+          Void render ( GameMemory& game_memory, SDL_Surface* back_buffer, Real32 interpolation );
 
           Void quit_game ( );
 
+          // bytes allocate_pools ( ) takes from the permanent arena
+          static inline Uint32 pool_bytes ( const Settings& settings );
+
+          // smallest game memory the settings fit in, the platform allocates at least this much
+          static inline Uint32 game_memory_bytes ( const Settings& settings );
+          Bool allocate_pools ( GameMemory& game_memory );
+          Void report_spawn_failures ( );
+
           Void update_intro ( GameMemory& game_memory, Real32 time_delta );
           Void update_game ( GameMemory& game_memory, Real32 time_delta );
           Void update_pause ( GameMemory& game_memory, Real32 time_delta );
@@ -107,7 +196,7 @@ namespace bryte
           Void handle_pause_input ( GameMemory& game_memory, const GameInput& game_input );
 
           Void render_intro ( GameMemory& game_memory, SDL_Surface* back_buffer );
-          Void render_game ( GameMemory& game_memory, SDL_Surface* back_buffer );
+          Void render_game ( GameMemory& game_memory, SDL_Surface* back_buffer, Real32 interpolation );
           Void render_pause ( GameMemory& game_memory, SDL_Surface* back_buffer );
 
           Bool spawn_enemy ( const Vector& position, Uint8 id, Direction facing, Pickup::Type drop );
@@ -118,6 +207,7 @@ namespace bryte
 
           Void start_game ( GameMemory& game_memory );
           Bool load_region ( GameMemory& game_memory );
+          Bool load_region_sheets ( GameMemory& game_memory, Bool restored );
 
           Void persist_map ( );
           Void spawn_map_enemies ( );
@@ -129,7 +219,9 @@ namespace bryte
           Void player_death ( );
           Bool check_player_block_projectile ( Projectile& projectile );
 
+          Void think_enemies ( float time_delta );
           Void update_enemies ( float time_delta );
+          Void update_enemy ( Enemy& enemy, const Vector& change, const Vector& player_center, float time_delta );
           Void enemy_death ( const Enemy& enemy );
 
           Void push_interactive ( const Location& tile, Direction dir, const Map& map );
@@ -137,10 +229,25 @@ namespace bryte
           Void update_interactives ( float time_delta );
 
           Void update_projectiles ( float time_delta );
+          Enemy* enemy_hit_by_point ( const Vector& point );
           Void update_bombs ( float time_delta );
           Void update_pickups ( float time_delta );
           Void update_emitters ( float time_delta );
           Void update_light ( );
+          Void update_displays ( );
+
+          Void reap_entities ( );
+
+          Void build_spatial_grids ( );
+          Void insert_enemy_into_grid ( Uint32 live_index );
+          Void insert_pickup_into_grid ( Uint32 live_index );
+
+          // the player isn't pooled, its handle always resolves
+          Entity* resolve_entity ( const EntityHandle& handle );
+          EntityHandle player_handle ( ) const;
+          Void store_previous_positions ( );
+          Void begin_interpolation ( Real32 interpolation );
+          Void end_interpolation ( );
 
           Void setup_emitters_from_map_lamps ( );
 
@@ -149,7 +256,10 @@ namespace bryte
 
           Void heal_enemies_in_range_of_fairy ( const Vector& position );
 
-          Void change_map ( Int32 map_index, Bool persist = true );
+          Bool random_open_position ( Vector* position );
+          Void fill_stress_pools ( );
+
+          Void change_map ( GameMemory& game_memory, Int32 map_index, Bool persist = true );
           Direction player_on_border ( );
 
           Bool change_region ( GameMemory& game_memory, Int32 region_index );
@@ -161,6 +271,10 @@ namespace bryte
 
      public:
 
+          // the permanent arena holds this plus the entity pools, the frame arena gets whatever is left
+          static const Uint32 c_permanent_arena_size = MEGABYTES ( 4 );
+          static const Uint32 c_min_frame_arena_size = MEGABYTES ( 16 );
+
           static const Int32 c_bomb_damage = 4;
           static const Int32 c_attack_damage = 1;
           static const Int32 c_block_damage = 0;
@@ -180,11 +294,18 @@ namespace bryte
 
           Player player;
 
-          EntityManager<Enemy,        32> enemies;
-          EntityManager<Pickup,        8> pickups;
-          EntityManager<Projectile,   64> projectiles;
-          EntityManager<Bomb,          8> bombs;
-          EntityManager<Emitter,      32> emitters;
+          EntityManager<Enemy,      EntityHandle::Pool::enemies>     enemies;
+          EntityManager<Pickup,     EntityHandle::Pool::pickups>     pickups;
+          EntityManager<Projectile, EntityHandle::Pool::projectiles> projectiles;
+          EntityManager<Bomb,       EntityHandle::Pool::bombs>       bombs;
+          EntityManager<Emitter,    EntityHandle::Pool::emitters>    emitters;
+
+          // indexed by live list position, rebuilt every update and added to as entities spawn
+          SpatialGrid enemy_grid;
+          SpatialGrid pickup_grid;
+
+          // a slot per enemy, think_enemies ( ) and update_enemies ( ) each fill it as they go
+          Enemy** enemy_order;
 
           Region       region;
           Map          map;
@@ -236,8 +357,30 @@ namespace bryte
           Bool invincible;
           Bool debug_text;
 #endif
+
+#ifdef PROFILE
+          Profiler profiler;
+#endif
      };
 
+     inline Uint32 State::pool_bytes ( const Settings& settings )
+     {
+          return decltype ( enemies )::bytes_for ( settings.max_enemies ) +
+                 decltype ( pickups )::bytes_for ( settings.max_pickups ) +
+                 decltype ( projectiles )::bytes_for ( settings.max_projectiles ) +
+                 decltype ( bombs )::bytes_for ( settings.max_bombs ) +
+                 decltype ( emitters )::bytes_for ( settings.max_emitters ) +
+                 SpatialGrid::bytes_for ( settings.max_enemies ) +
+                 SpatialGrid::bytes_for ( settings.max_pickups ) +
+                 GameMemory::array_bytes<Enemy*> ( settings.max_enemies );
+     }
+
+     inline Uint32 State::game_memory_bytes ( const Settings& settings )
+     {
+          return GameMemory::table_bytes ( ) + c_permanent_arena_size + pool_bytes ( settings ) +
+                 c_min_frame_arena_size;
+     }
+
      struct MemoryLocations {
           State*     state;
 
@@ -247,10 +390,12 @@ namespace bryte
 
 // exported functions to be called by the application
 extern "C" Bool game_init       ( GameMemory&, Void* settings );
+extern "C" Bool game_restore    ( GameMemory&, Void* settings );
+extern "C" Bool game_resume     ( GameMemory& );
 extern "C" Void game_destroy    ( GameMemory& );
 extern "C" Void game_user_input ( GameMemory&, const GameInput& );
 extern "C" Void game_update     ( GameMemory&, Real32 );
-extern "C" Void game_render     ( GameMemory&, SDL_Surface* );
+extern "C" Void game_render     ( GameMemory&, SDL_Surface*, Real32 interpolation );
 
 #endif
 
@@ -13,6 +13,16 @@ Void print_help ( )
      printf ( "  -i map index to load from master list\n" );
      printf ( "  -x tile x to spawn player on\n" );
      printf ( "  -y tile y to spawn player on\n" );
+     printf ( "  -q pool capacity, pool is enemies, pickups, projectiles, bombs or emitters\n" );
+     printf ( "  -s stress, keeps %u enemies and %u projectiles alive, -q after it changes those\n",
+              bryte::Settings::c_stress_max_enemies, bryte::Settings::c_stress_max_projectiles );
+     printf ( "  -l smooth light, blends between tiles rather than lighting each one evenly\n" );
+     printf ( "  -w tile walls, characters collide against every solid tile rather than merged walls\n" );
+     printf ( "  -f frames per second to render at, 60 by default\n" );
+     printf ( "  -c copy the back buffer into the window each frame rather than streaming it\n" );
+     printf ( "  -b replay a recorded session as fast as possible and write frame timings to this file\n" );
+     printf ( "  -m game memory snapshot the benchmark starts from, bryte_memory.mem by default\n" );
+     printf ( "  -p recorded input the benchmark replays, bryte_input.in by default\n" );
      printf ( "  -h displays this helpful information\n\n" );
 }
 
@@ -30,8 +40,16 @@ Int32 main ( Int32 argc, Char8** argv )
      settings.shared_library_path           = "./bryte_game.so";
 
      settings.game_memory_allocation_size   = MEGABYTES ( 32 );
+     settings.game_memory_warning_threshold = GameMemory::c_default_warning_threshold;
 
-     settings.locked_frames_per_second      = 30;
+     settings.simulation_frames_per_second  = 30;
+     settings.render_frames_per_second      = 60;
+
+     settings.streaming_back_buffer         = true;
+
+     settings.benchmark_report_path         = nullptr;
+     settings.benchmark_memory_path         = Simulation::c_game_memory_filepath;
+     settings.benchmark_input_path          = Simulation::c_record_input_filepath;
 
      bryte::Settings bryte_settings;
 
@@ -39,6 +57,9 @@ Int32 main ( Int32 argc, Char8** argv )
      bryte_settings.map_index = 0;
      bryte_settings.player_spawn_tile_x = 6;
      bryte_settings.player_spawn_tile_y = 2;
+     bryte_settings.default_capacities ( );
+     bryte_settings.smooth_light = false;
+     bryte_settings.merged_walls = true;
 
      for ( int i = 1; i < argc; ++i ) {
           if ( strcmp ( argv [ i ], "-h" ) == 0 ) {
@@ -64,12 +85,56 @@ Int32 main ( Int32 argc, Char8** argv )
                     bryte_settings.player_spawn_tile_y = atoi ( argv [ i + 1 ] );
                     ++i;
                }
+          } else if ( strcmp ( argv [ i ], "-q" ) == 0 ) {
+               if ( argc > i + 2 ) {
+                    if ( !bryte_settings.set_capacity ( argv [ i + 1 ], atoi ( argv [ i + 2 ] ) ) ) {
+                         printf ( "unrecognized pool: %s, see help.\n", argv [ i + 1 ] );
+                         return 0;
+                    }
+                    i += 2;
+               }
+          } else if ( strcmp ( argv [ i ], "-s" ) == 0 ) {
+               bryte_settings.enable_stress ( );
+          } else if ( strcmp ( argv [ i ], "-l" ) == 0 ) {
+               bryte_settings.smooth_light = true;
+          } else if ( strcmp ( argv [ i ], "-w" ) == 0 ) {
+               bryte_settings.merged_walls = false;
+          } else if ( strcmp ( argv [ i ], "-f" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.render_frames_per_second = atoi ( argv [ i + 1 ] );
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-c" ) == 0 ) {
+               settings.streaming_back_buffer = false;
+          } else if ( strcmp ( argv [ i ], "-b" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.benchmark_report_path = argv [ i + 1 ];
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-m" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.benchmark_memory_path = argv [ i + 1 ];
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-p" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.benchmark_input_path = argv [ i + 1 ];
+                    ++i;
+               }
           } else {
                printf ( "unrecognized option: %s, see help.\n", argv [ i ] );
                return 0;
           }
      }
 
+     // the entity pools come out of game memory, grow it for any too big for the default
+     Uint32 needed_memory = bryte::State::game_memory_bytes ( bryte_settings );
+
+     if ( settings.game_memory_allocation_size < needed_memory ) {
+          LOG_INFO ( "Growing game memory to %u bytes to fit the entity pools\n", needed_memory );
+          settings.game_memory_allocation_size = needed_memory;
+     }
+
      Application application;
 
      return application.run_game ( settings, &bryte_settings ) ? 0 : 1;
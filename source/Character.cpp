@@ -255,7 +255,96 @@ static Bool check_wall ( Real32 wall, Real32 wall_min, Real32 wall_max,
      return false;
 }
 
-Void Character::update ( Real32 time_delta, const Map& map, Interactives& interactives )
+// checks the edges of a rect already grown by the character's half dimensions, an edge closer than
+// the closest time sets the wall normal. Returns the side of the character that hit, or Direction::count
+static Direction check_rect ( Real32 left, Real32 bottom, Real32 right, Real32 top,
+                              const Vector& center, const Vector& change_in_position,
+                              Real32* closest_time_intersection, Vector* wall_normal )
+{
+     Direction hit = Direction::count;
+
+     if ( check_wall ( left, bottom, top, center.x ( ), change_in_position.x ( ),
+                       center.y ( ), change_in_position.y ( ), closest_time_intersection ) ) {
+          *wall_normal = { -1.0f, 0.0f };
+          hit = Direction::right;
+     }
+
+     if ( check_wall ( right, bottom, top, center.x ( ), change_in_position.x ( ),
+                       center.y ( ), change_in_position.y ( ), closest_time_intersection ) ) {
+          *wall_normal = { 1.0f, 0.0f };
+          hit = Direction::left;
+     }
+
+     if ( check_wall ( bottom, left, right, center.y ( ), change_in_position.y ( ),
+                       center.x ( ), change_in_position.x ( ), closest_time_intersection ) ) {
+          *wall_normal = { 0.0f, -1.0f };
+          hit = Direction::up;
+     }
+
+     if ( check_wall ( top, left, right, center.y ( ), change_in_position.y ( ),
+                       center.x ( ), change_in_position.x ( ), closest_time_intersection ) ) {
+          *wall_normal = { 0.0f, 1.0f };
+          hit = Direction::down;
+     }
+
+     return hit;
+}
+
+// the tiles checked are clamped to the map and the ring just outside it. A map holds at most c_max_tiles
+// and is at least a tile on each side, so the ring adds at most 2 * ( c_max_tiles + 1 ) + 4 more
+static const Uint32 c_max_checked_tiles = Map::c_max_tiles + 2 * ( Map::c_max_tiles + 1 ) + 4;
+
+// each checked tile adds at most one blocker, cutting the ignore tile out of its wall adds 3 more
+static const Uint32 c_max_blockers = c_max_checked_tiles + 3;
+
+// adds the wall, split into the pieces around the tile if it covers it
+static Void add_wall_without_tile ( const Map::Wall& wall, const Location& tile,
+                                    Map::Wall* walls, Uint32* wall_count )
+{
+     if ( tile.x < wall.left || tile.x > wall.right ||
+          tile.y < wall.bottom || tile.y > wall.top ) {
+          ASSERT ( *wall_count < c_max_blockers );
+          walls [ (*wall_count)++ ] = wall;
+          return;
+     }
+
+     Int16 x = tile.x;
+     Int16 y = tile.y;
+
+     ASSERT ( *wall_count + 4 <= c_max_blockers );
+
+     // the rows below and above the tile keep the wall's width, its own row is split around it
+     if ( y > wall.bottom ) {
+          walls [ (*wall_count)++ ] = Map::Wall { wall.left, wall.bottom, wall.right, static_cast<Int16>( y - 1 ) };
+     }
+
+     if ( y < wall.top ) {
+          walls [ (*wall_count)++ ] = Map::Wall { wall.left, static_cast<Int16>( y + 1 ), wall.right, wall.top };
+     }
+
+     if ( x > wall.left ) {
+          walls [ (*wall_count)++ ] = Map::Wall { wall.left, y, static_cast<Int16>( x - 1 ), y };
+     }
+
+     if ( x < wall.right ) {
+          walls [ (*wall_count)++ ] = Map::Wall { static_cast<Int16>( x + 1 ), y, wall.right, y };
+     }
+}
+
+Void Character::update ( Real32 time_delta, const Map& map, Interactives& interactives, Bool merged_walls )
+{
+     KinematicsBatch<1> kinematics;
+
+     begin_update ( time_delta );
+
+     kinematics.clear ( );
+     kinematics.add ( *this );
+     kinematics.integrate ( time_delta );
+
+     finish_update ( time_delta, kinematics.finish ( 0 ), map, interactives, merged_walls );
+}
+
+Void Character::begin_update ( Real32 time_delta )
 {
      // tick stopwatches
      state_watch.tick ( time_delta );
@@ -358,18 +447,11 @@ Void Character::update ( Real32 time_delta, const Map& map, Interactives& intera
           break;
      }
 
-     // TEMPORARY, slow character down
-     if ( on_ice ) {
-          acceleration += velocity * -( c_ice_decel * deceleration_scale );
-     } else {
-          acceleration += velocity * -deceleration_scale;
-     }
-
-     Vector change_in_position = ( velocity * time_delta ) +
-                                 ( acceleration * ( 0.5f * square ( time_delta ) ) );
-
-     velocity = ( acceleration * time_delta ) + velocity;
+}
 
+Void Character::finish_update ( Real32 time_delta, Vector change_in_position,
+                                const Map& map, Interactives& interactives, Bool merged_walls )
+{
      if ( effected_by_element != Element::ice ) {
           // Note: move along the current animation type as long as
           //       the character is not frozen
@@ -428,11 +510,44 @@ Void Character::update ( Real32 time_delta, const Map& map, Interactives& intera
           }
      }
 
-     // TODO: move tiles based on width
-     Int32 min_check_tile_x = center_tile_x - 1;
-     Int32 min_check_tile_y = center_tile_y - 1;
-     Int32 max_check_tile_x = center_tile_x + 1;
-     Int32 max_check_tile_y = center_tile_y + 1;
+     // check every tile the collision box sweeps through this step, plus a tile around it, so long
+     // steps from knockback or a hitch can't carry us past a wall
+     Vector swept_min { center.x ( ) - half_width, center.y ( ) - half_height };
+     Vector swept_max { center.x ( ) + half_width, center.y ( ) + half_height };
+
+     if ( change_in_position.x ( ) < 0.0f ) {
+          swept_min.set_x ( swept_min.x ( ) + change_in_position.x ( ) );
+     } else {
+          swept_max.set_x ( swept_max.x ( ) + change_in_position.x ( ) );
+     }
+
+     if ( change_in_position.y ( ) < 0.0f ) {
+          swept_min.set_y ( swept_min.y ( ) + change_in_position.y ( ) );
+     } else {
+          swept_max.set_y ( swept_max.y ( ) + change_in_position.y ( ) );
+     }
+
+     Int32 min_check_tile_x = meters_to_pixels ( swept_min.x ( ) ) / Map::c_tile_dimension_in_pixels - 1;
+     Int32 min_check_tile_y = meters_to_pixels ( swept_min.y ( ) ) / Map::c_tile_dimension_in_pixels - 1;
+     Int32 max_check_tile_x = meters_to_pixels ( swept_max.x ( ) ) / Map::c_tile_dimension_in_pixels + 1;
+     Int32 max_check_tile_y = meters_to_pixels ( swept_max.y ( ) ) / Map::c_tile_dimension_in_pixels + 1;
+
+     // never check less than the tiles around the center
+     if ( min_check_tile_x > center_tile_x - 1 ) {
+          min_check_tile_x = center_tile_x - 1;
+     }
+
+     if ( min_check_tile_y > center_tile_y - 1 ) {
+          min_check_tile_y = center_tile_y - 1;
+     }
+
+     if ( max_check_tile_x < center_tile_x + 1 ) {
+          max_check_tile_x = center_tile_x + 1;
+     }
+
+     if ( max_check_tile_y < center_tile_y + 1 ) {
+          max_check_tile_y = center_tile_y + 1;
+     }
 
      // Note: Bounds are outsize the map, we treat the outsides of the map as solid so that enemies
      //       collided against the edges if they are open
@@ -441,101 +556,104 @@ Void Character::update ( Real32 time_delta, const Map& map, Interactives& intera
      CLAMP ( max_check_tile_x, -1, map.width  ( ) );
      CLAMP ( max_check_tile_y, -1, map.height ( ) );
 
-     Real32 time_remaining = 1.0f;
-
-     collided_last_frame = Direction::count;
+     ASSERT ( static_cast<Uint32>( ( max_check_tile_x - min_check_tile_x + 1 ) *
+                                   ( max_check_tile_y - min_check_tile_y + 1 ) ) <= c_max_checked_tiles );
 
-     for ( int i = 0; i < 4 && time_remaining > 0.0f; ++i ) {
-          // Note: When I added code to exit early when we collided against a wall,
-          //       the player could clip through walls at a certain point on each tile
-          Vector wall_normal;
-          Real32 closest_time_intersection = time_remaining;
-          Direction push_direction = Direction::count;
-          Location tile;
+     // gather everything in the area we could hit once, solid tiles and the outside of the map come
+     // merged into walls. The ignore tile is cut out of the wall covering it
+     Map::Wall blockers [ c_max_blockers ];
+     Uint32 blocker_count = 0;
+     Uint32 added_walls [ c_max_blockers ];
+     Uint32 added_wall_count = 0;
+     Location tile;
 
-          // loop over tile area
-          for ( tile.y = min_check_tile_y; tile.y <= max_check_tile_y; ++tile.y ) {
-               for ( tile.x = min_check_tile_x; tile.x <= max_check_tile_x; ++tile.x ) {
+     for ( tile.y = min_check_tile_y; tile.y <= max_check_tile_y; ++tile.y ) {
+          for ( tile.x = min_check_tile_x; tile.x <= max_check_tile_x; ++tile.x ) {
 
-                    if ( tile == ignore_tile ) {
-                         continue;
-                    }
+               if ( tile == ignore_tile ) {
+                    continue;
+               }
 
-                    if ( map.tile_location_is_valid ( tile ) && !map.get_tile_location_solid ( tile ) ) {
-                         if ( interactives.is_walkable ( tile, facing ) ) {
-                              Auto& interactive = interactives.get_from_tile ( tile );
+               if ( map.tile_location_is_valid ( tile ) && !map.get_tile_location_solid ( tile ) ) {
+                    if ( interactives.is_walkable ( tile, facing ) ) {
+                         const Auto& interactive = interactives.cget_from_tile ( tile );
 
-                              if ( interactive.type == Interactive::Type::exit ) {
-                                   if ( !collides_with_exits ) {
-                                        continue;
-                                   }
-                              } else {
+                         if ( interactive.type == Interactive::Type::exit ) {
+                              if ( !collides_with_exits ) {
                                    continue;
                               }
                          } else {
-                              if ( flies ) {
-                                   continue;
-                              }
+                              continue;
                          }
-                    }
-
-                    Real32 left   = pixels_to_meters ( tile.x * Map::c_tile_dimension_in_pixels );
-                    Real32 right  = left + Map::c_tile_dimension_in_meters;
-                    Real32 bottom = pixels_to_meters ( tile.y * Map::c_tile_dimension_in_pixels );
-                    Real32 top    = bottom + Map::c_tile_dimension_in_meters;
-
-                    // minkowski sum extruding
-                    left   -= half_width;
-                    right  += half_width;
-                    bottom -= half_height;
-                    top    += half_height;
-
-                    if ( check_wall ( left, bottom, top, center.x ( ), change_in_position.x ( ),
-                                      center.y ( ), change_in_position.y ( ),
-                                      &closest_time_intersection ) ) {
-                         wall_normal = { -1.0f, 0.0f };
-                         collided_last_frame = Direction::right;
-
-                         if ( map.tile_location_is_valid ( tile ) &&
-                              !interactives.is_walkable ( tile, facing ) ) {
-                              push_direction = Direction::right;
+                    } else {
+                         if ( flies ) {
+                              continue;
                          }
                     }
+               } else if ( merged_walls ) {
+                    Uint32 w = map.wall_covering ( tile );
+                    Uint32 a = 0;
 
-                    if ( check_wall ( right, bottom, top, center.x ( ), change_in_position.x ( ),
-                                      center.y ( ), change_in_position.y ( ),
-                                      &closest_time_intersection ) ) {
-                         wall_normal = { 1.0f, 0.0f };
-                         collided_last_frame = Direction::left;
+                    // only a handful of walls are near a character unless it moved a long way
+                    while ( a < added_wall_count && added_walls [ a ] != w ) {
+                         a++;
+                    }
 
-                         if ( map.tile_location_is_valid ( tile ) &&
-                              !interactives.is_walkable ( tile, facing ) ) {
-                              push_direction = Direction::left;
-                         }
+                    if ( a == added_wall_count ) {
+                         added_walls [ added_wall_count++ ] = w;
+                         add_wall_without_tile ( map.wall ( w ), ignore_tile, blockers, &blocker_count );
                     }
 
-                    if ( check_wall ( bottom, left, right, center.y ( ), change_in_position.y ( ),
-                                      center.x ( ), change_in_position.x ( ),
-                                      &closest_time_intersection ) ) {
-                         wall_normal = { 0.0f, -1.0f };
-                         collided_last_frame = Direction::up;
+                    continue;
+               }
 
-                         if ( map.tile_location_is_valid ( tile ) &&
-                              !interactives.is_walkable ( tile, facing ) ) {
-                              push_direction = Direction::up;
-                         }
-                    }
+               ASSERT ( blocker_count < c_max_blockers );
 
-                    if ( check_wall ( top, left, right, center.y ( ), change_in_position.y ( ),
-                                      center.x ( ), change_in_position.x ( ),
-                                      &closest_time_intersection ) ) {
-                         wall_normal = { 0.0f, 1.0f };
-                         collided_last_frame = Direction::down;
+               blockers [ blocker_count++ ] = Map::Wall { static_cast<Int16>( tile.x ), static_cast<Int16>( tile.y ),
+                                                          static_cast<Int16>( tile.x ), static_cast<Int16>( tile.y ) };
+          }
+     }
 
-                         if ( map.tile_location_is_valid ( tile ) &&
-                              !interactives.is_walkable ( tile, facing ) ) {
-                              push_direction = Direction::down;
-                         }
+     Real32 time_remaining = 1.0f;
+
+     collided_last_frame = Direction::count;
+
+     for ( int i = 0; i < 4 && time_remaining > 0.0f; ++i ) {
+          // Note: When I added code to exit early when we collided against a wall,
+          //       the player could clip through walls at a certain point on each tile
+          Vector wall_normal;
+          Real32 closest_time_intersection = time_remaining;
+          Direction push_direction = Direction::count;
+
+          for ( Uint32 b = 0; b < blocker_count; ++b ) {
+               const Auto& blocker = blockers [ b ];
+
+               Real32 left   = pixels_to_meters ( blocker.left * Map::c_tile_dimension_in_pixels );
+               Real32 right  = pixels_to_meters ( ( blocker.right + 1 ) * Map::c_tile_dimension_in_pixels );
+               Real32 bottom = pixels_to_meters ( blocker.bottom * Map::c_tile_dimension_in_pixels );
+               Real32 top    = pixels_to_meters ( ( blocker.top + 1 ) * Map::c_tile_dimension_in_pixels );
+
+               // minkowski sum extruding
+               left   -= half_width;
+               right  += half_width;
+               bottom -= half_height;
+               top    += half_height;
+
+               Direction hit = check_rect ( left, bottom, right, top, center, change_in_position,
+                                            &closest_time_intersection, &wall_normal );
+
+               if ( hit != Direction::count ) {
+                    collided_last_frame = hit;
+
+                    // the tile we touched decides whether we are pushing something
+                    Location hit_tile = Map::vector_to_location ( center + change_in_position * closest_time_intersection );
+
+                    CLAMP ( hit_tile.x, blocker.left, blocker.right );
+                    CLAMP ( hit_tile.y, blocker.bottom, blocker.top );
+
+                    if ( map.tile_location_is_valid ( hit_tile ) &&
+                         !interactives.is_walkable ( hit_tile, facing ) ) {
+                         push_direction = hit;
                     }
                }
           }
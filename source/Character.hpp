@@ -4,6 +4,7 @@
 #include "Direction.hpp"
 #include "Entity.hpp"
 #include "StopWatch.hpp"
+#include "Utils.hpp"
 
 namespace bryte
 {
@@ -35,7 +36,15 @@ namespace bryte
           Void process_health ( );
           Void effect_with_element ( Element element );
 
-          Void update ( Real32 time_delta, const Map& map, Interactives& interactives );
+          // merged_walls collides against the map's merged walls rather than every solid tile
+          Void update ( Real32 time_delta, const Map& map, Interactives& interactives, Bool merged_walls );
+
+          // update ( ) split around integration, so a KinematicsBatch can integrate many characters
+          // at once. begin_update ( ) works out this step's acceleration and finish_update ( ) walks
+          // the integrated change in position, resolving collisions with the map
+          Void begin_update ( Real32 time_delta );
+          Void finish_update ( Real32 time_delta, Vector change_in_position,
+                               const Map& map, Interactives& interactives, Bool merged_walls );
 
           Real32 attack_x ( ) const;
           Real32 attack_y ( ) const;
@@ -204,6 +213,91 @@ namespace bryte
      inline Bool Character::is_attacking ( ) const { return state == Character::State::attacking; }
      inline Bool Character::is_pushing ( ) const { return state == Character::State::pushing; }
      inline Bool Character::is_blocking ( ) const { return state == Character::State::blocking; }
+
+     // the velocities and accelerations of a batch of characters copied into separate arrays, so
+     // deceleration and integration run as one loop the compiler can vectorize. bryte_bench
+     // kinematics measures the copying against keeping the fields in arrays between steps
+     template < Uint32 MAX >
+     struct KinematicsBatch {
+
+          inline Void clear ( );
+
+          // after the character's begin_update ( )
+          inline Bool add ( Character& character );
+
+          inline Void integrate ( Real32 time_delta );
+
+          // writes the character's new velocity back and returns how far it moves this step
+          inline Vector finish ( Uint32 index );
+
+          Character* characters [ MAX ];
+
+          Real32 velocity_x [ MAX ];
+          Real32 velocity_y [ MAX ];
+          Real32 acceleration_x [ MAX ];
+          Real32 acceleration_y [ MAX ];
+          Real32 deceleration [ MAX ];
+          Real32 change_x [ MAX ];
+          Real32 change_y [ MAX ];
+
+          Uint32 count;
+     };
+
+     template < Uint32 MAX >
+     inline Void KinematicsBatch<MAX>::clear ( )
+     {
+          count = 0;
+     }
+
+     template < Uint32 MAX >
+     inline Bool KinematicsBatch<MAX>::add ( Character& character )
+     {
+          if ( count >= MAX ) {
+               return false;
+          }
+
+          characters [ count ] = &character;
+          velocity_x [ count ] = character.velocity.x ( );
+          velocity_y [ count ] = character.velocity.y ( );
+          acceleration_x [ count ] = character.acceleration.x ( );
+          acceleration_y [ count ] = character.acceleration.y ( );
+
+          deceleration [ count ] = character.on_ice ? -( Character::c_ice_decel * character.deceleration_scale ) :
+                                                      -character.deceleration_scale;
+          count++;
+
+          return true;
+     }
+
+     template < Uint32 MAX >
+     inline Void KinematicsBatch<MAX>::integrate ( Real32 time_delta )
+     {
+          Real32 half_time_delta_squared = 0.5f * square ( time_delta );
+
+          for ( Uint32 i = 0; i < count; ++i ) {
+               acceleration_x [ i ] += velocity_x [ i ] * deceleration [ i ];
+               acceleration_y [ i ] += velocity_y [ i ] * deceleration [ i ];
+
+               change_x [ i ] = ( velocity_x [ i ] * time_delta ) + ( acceleration_x [ i ] * half_time_delta_squared );
+               change_y [ i ] = ( velocity_y [ i ] * time_delta ) + ( acceleration_y [ i ] * half_time_delta_squared );
+
+               velocity_x [ i ] = ( acceleration_x [ i ] * time_delta ) + velocity_x [ i ];
+               velocity_y [ i ] = ( acceleration_y [ i ] * time_delta ) + velocity_y [ i ];
+          }
+     }
+
+     template < Uint32 MAX >
+     inline Vector KinematicsBatch<MAX>::finish ( Uint32 index )
+     {
+          ASSERT ( index < count );
+
+          Auto& character = *characters [ index ];
+
+          character.velocity.set ( velocity_x [ index ], velocity_y [ index ] );
+          character.acceleration.set ( acceleration_x [ index ], acceleration_y [ index ] );
+
+          return Vector { change_x [ index ], change_y [ index ] };
+     }
 }
 
 #endif
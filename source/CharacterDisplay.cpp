@@ -3,6 +3,7 @@
 #include "Utils.hpp"
 #include "GameMemory.hpp"
 #include "Bitmap.hpp"
+#include "Profiler.hpp"
 
 using namespace bryte;
 
@@ -280,6 +281,8 @@ Void CharacterDisplay::tick ( )
 Void CharacterDisplay::render_player ( SDL_Surface* back_buffer, const Character& player,
                                        Real32 camera_x, Real32 camera_y )
 {
+     PROFILE_ZONE ( "CharacterDisplay::render_player" );
+
      if ( player.state == Character::State::attacking ) {
           render_character_attack ( back_buffer, horizontal_sword_sheet, vertical_sword_sheet,
                                     player, camera_x, camera_y );
@@ -0,0 +1,159 @@
+#include "Collision.hpp"
+
+#include "KernelSelect.hpp"
+
+#include <cstring>
+
+using namespace bryte;
+
+typedef Uint32 ( *CollisionKernelFunction ) ( Real32 left, Real32 bottom, Real32 right, Real32 top,
+                                              const Real32* lefts, const Real32* bottoms,
+                                              const Real32* rights, const Real32* tops,
+                                              Uint32 start, Uint32 count, Bool* hits );
+
+static Uint32 collide_scalar ( Real32 left, Real32 bottom, Real32 right, Real32 top,
+                               const Real32* lefts, const Real32* bottoms,
+                               const Real32* rights, const Real32* tops,
+                               Uint32 start, Uint32 count, Bool* hits )
+{
+     Uint32 hit_count = 0;
+
+     for ( Uint32 i = start; i < count; ++i ) {
+          hits [ i ] = ( lefts [ i ] <= right ) & ( left <= rights [ i ] ) &
+                       ( bottoms [ i ] <= top ) & ( bottom <= tops [ i ] );
+          hit_count += hits [ i ];
+     }
+
+     return hit_count;
+}
+
+#ifdef BRYTE_X86
+
+static inline Uint32 sum_lanes ( __m128i counts )
+{
+     Int32 lanes [ 4 ];
+
+     _mm_storeu_si128 ( reinterpret_cast<__m128i*>( lanes ), counts );
+
+     return lanes [ 0 ] + lanes [ 1 ] + lanes [ 2 ] + lanes [ 3 ];
+}
+
+// sse2 is part of x86_64 so this never needs checking for
+static Uint32 collide_sse ( Real32 left, Real32 bottom, Real32 right, Real32 top,
+                            const Real32* lefts, const Real32* bottoms,
+                            const Real32* rights, const Real32* tops,
+                            Uint32 start, Uint32 count, Bool* hits )
+{
+     __m128 l = _mm_set1_ps ( left );
+     __m128 b = _mm_set1_ps ( bottom );
+     __m128 r = _mm_set1_ps ( right );
+     __m128 t = _mm_set1_ps ( top );
+
+     __m128i counts = _mm_setzero_si128 ( );
+     Uint32 i = start;
+
+     for ( ; i + 4 <= count; i += 4 ) {
+          __m128 overlap = _mm_and_ps ( _mm_and_ps ( _mm_cmple_ps ( _mm_loadu_ps ( lefts + i ), r ),
+                                                     _mm_cmple_ps ( l, _mm_loadu_ps ( rights + i ) ) ),
+                                        _mm_and_ps ( _mm_cmple_ps ( _mm_loadu_ps ( bottoms + i ), t ),
+                                                     _mm_cmple_ps ( b, _mm_loadu_ps ( tops + i ) ) ) );
+          // narrow the all ones lanes down to a byte of 1 each and store them as Bools
+          __m128i lanes = _mm_and_si128 ( _mm_castps_si128 ( overlap ), _mm_set1_epi32 ( 1 ) );
+          __m128i bytes = _mm_packus_epi16 ( _mm_packs_epi32 ( lanes, lanes ), lanes );
+          Int32 packed = _mm_cvtsi128_si32 ( bytes );
+
+          memcpy ( hits + i, &packed, 4 );
+          counts = _mm_add_epi32 ( counts, lanes );
+     }
+
+     return sum_lanes ( counts ) + collide_scalar ( left, bottom, right, top, lefts, bottoms, rights, tops, i, count, hits );
+}
+
+__attribute__ (( target ( "avx" ) ))
+static Uint32 collide_avx ( Real32 left, Real32 bottom, Real32 right, Real32 top,
+                            const Real32* lefts, const Real32* bottoms,
+                            const Real32* rights, const Real32* tops,
+                            Uint32 start, Uint32 count, Bool* hits )
+{
+     __m256 l = _mm256_set1_ps ( left );
+     __m256 b = _mm256_set1_ps ( bottom );
+     __m256 r = _mm256_set1_ps ( right );
+     __m256 t = _mm256_set1_ps ( top );
+
+     __m128i counts = _mm_setzero_si128 ( );
+     Uint32 i = start;
+
+     for ( ; i + 8 <= count; i += 8 ) {
+          __m256 overlap = _mm256_and_ps ( _mm256_and_ps ( _mm256_cmp_ps ( _mm256_loadu_ps ( lefts + i ), r, _CMP_LE_OQ ),
+                                                           _mm256_cmp_ps ( l, _mm256_loadu_ps ( rights + i ), _CMP_LE_OQ ) ),
+                                           _mm256_and_ps ( _mm256_cmp_ps ( _mm256_loadu_ps ( bottoms + i ), t, _CMP_LE_OQ ),
+                                                           _mm256_cmp_ps ( b, _mm256_loadu_ps ( tops + i ), _CMP_LE_OQ ) ) );
+          __m128i low = _mm_and_si128 ( _mm_castps_si128 ( _mm256_castps256_ps128 ( overlap ) ), _mm_set1_epi32 ( 1 ) );
+          __m128i high = _mm_and_si128 ( _mm_castps_si128 ( _mm256_extractf128_ps ( overlap, 1 ) ), _mm_set1_epi32 ( 1 ) );
+          __m128i words = _mm_packs_epi32 ( low, high );
+          __m128i bytes = _mm_packus_epi16 ( words, words );
+
+          _mm_storel_epi64 ( reinterpret_cast<__m128i*>( hits + i ), bytes );
+          counts = _mm_add_epi32 ( counts, _mm_add_epi32 ( low, high ) );
+     }
+
+     Uint32 hit_count = sum_lanes ( counts );
+
+     // the sse kernel isn't vex encoded, clear the upper halves first so mixing them isn't slow
+     _mm256_zeroupper ( );
+
+     // finish the last few with the narrower kernel
+     return hit_count + collide_sse ( left, bottom, right, top, lefts, bottoms, rights, tops, i, count, hits );
+}
+
+#endif
+
+static const CollisionKernelFunction c_kernel_functions [ CollisionKernel::kernel_count ] = {
+     collide_scalar,
+#ifdef BRYTE_X86
+     collide_sse,
+     collide_avx
+#else
+     nullptr,
+     nullptr
+#endif
+};
+
+static const Char8* c_kernel_names [ CollisionKernel::kernel_count ] = {
+     "scalar",
+     "sse",
+     "avx"
+};
+
+static const CpuFeature c_kernel_features [ CollisionKernel::kernel_count ] = {
+     CpuFeature::cpu_baseline,
+     CpuFeature::cpu_sse2,
+     CpuFeature::cpu_avx
+};
+
+// statics are reset each time the game code is reloaded
+static KernelSelect g_kernels ( "collision", c_kernel_names, c_kernel_features, CollisionKernel::kernel_count );
+
+Uint32 bryte::rect_collides_with_rects ( Real32 left, Real32 bottom, Real32 right, Real32 top,
+                                         const Real32* lefts, const Real32* bottoms,
+                                         const Real32* rights, const Real32* tops,
+                                         Uint32 count, Bool* hits )
+{
+     return c_kernel_functions [ g_kernels.selected ( ) ] ( left, bottom, right, top,
+                                                            lefts, bottoms, rights, tops, 0, count, hits );
+}
+
+Bool bryte::set_collision_kernel ( CollisionKernel kernel )
+{
+     return g_kernels.select ( kernel );
+}
+
+CollisionKernel bryte::collision_kernel ( )
+{
+     return static_cast<CollisionKernel>( g_kernels.selected ( ) );
+}
+
+const Char8* bryte::collision_kernel_name ( CollisionKernel kernel )
+{
+     return g_kernels.name ( kernel );
+}
@@ -0,0 +1,75 @@
+#ifndef BRYTE_COLLISION_HPP
+#define BRYTE_COLLISION_HPP
+
+#include "Types.hpp"
+#include "Utils.hpp"
+
+namespace bryte
+{
+     enum CollisionKernel {
+          scalar,
+          sse,
+          avx,
+          kernel_count
+     };
+
+     // tests one rect against count packed rects using the same separating axis test as
+     // rect_collides_with_rect ( ), hits [ i ] is set for every rect it overlaps. Returns the hit count
+     Uint32 rect_collides_with_rects ( Real32 left, Real32 bottom, Real32 right, Real32 top,
+                                       const Real32* lefts, const Real32* bottoms,
+                                       const Real32* rights, const Real32* tops,
+                                       Uint32 count, Bool* hits );
+
+     // the widest kernel the cpu supports is picked the first time rects are tested, this forces one
+     Bool set_collision_kernel ( CollisionKernel kernel );
+     CollisionKernel collision_kernel ( );
+     const Char8* collision_kernel_name ( CollisionKernel kernel );
+
+     // gathers rects into separate arrays of edges so the kernels can load several at once
+     template < Uint32 MAX >
+     struct CollisionBatch {
+
+          inline Void clear ( );
+          inline Bool add ( Real32 left, Real32 bottom, Real32 width, Real32 height );
+
+          inline Uint32 test ( Real32 left, Real32 bottom, Real32 width, Real32 height, Bool* hits ) const;
+
+          Real32 lefts [ MAX ];
+          Real32 bottoms [ MAX ];
+          Real32 rights [ MAX ];
+          Real32 tops [ MAX ];
+          Uint32 count;
+     };
+
+     template < Uint32 MAX >
+     inline Void CollisionBatch<MAX>::clear ( )
+     {
+          count = 0;
+     }
+
+     template < Uint32 MAX >
+     inline Bool CollisionBatch<MAX>::add ( Real32 left, Real32 bottom, Real32 width, Real32 height )
+     {
+          if ( count >= MAX ) {
+               return false;
+          }
+
+          lefts [ count ] = left;
+          bottoms [ count ] = bottom;
+          rights [ count ] = left + width;
+          tops [ count ] = bottom + height;
+          count++;
+
+          return true;
+     }
+
+     template < Uint32 MAX >
+     inline Uint32 CollisionBatch<MAX>::test ( Real32 left, Real32 bottom, Real32 width, Real32 height,
+                                               Bool* hits ) const
+     {
+          return rect_collides_with_rects ( left, bottom, left + width, bottom + height,
+                                            lefts, bottoms, rights, tops, count, hits );
+     }
+}
+
+#endif
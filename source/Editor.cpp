@@ -6,6 +6,7 @@
 #include "Bitmap.hpp"
 #include "MapDisplay.hpp"
 #include "Player.hpp"
+#include "Region.hpp"
 
 #include <cstdio>
 
@@ -14,9 +15,23 @@ using namespace bryte;
 
 const Real32 State::c_camera_speed = 20.0f;
 
+static const Uint32 c_permanent_arena_size = MEGABYTES ( 4 );
+
+// right clicking a lamp steps it through these
+static const Uint32 c_lamp_colors [ ] = {
+     Map::c_white_lamp,
+     0xFFC080,
+     0xFF8040,
+     0x80A0FF,
+     0x80FF90,
+     0xFF6060,
+};
+
+static const Int32 c_lamp_color_count = sizeof ( c_lamp_colors ) / sizeof ( c_lamp_colors [ 0 ] );
+
 static State* get_state ( GameMemory& game_memory )
 {
-     return reinterpret_cast<MemoryLocations*>( game_memory.location ( ) )->state;
+     return reinterpret_cast<MemoryLocations*>( game_memory.arena_location ( GameMemory::Arena::permanent ) )->state;
 }
 
 Bool State::mouse_on_map ( )
@@ -295,9 +310,24 @@ Void State::mouse_button_right_clicked ( )
      case Mode::decor:
           break;
      case Mode::light:
-          current_lamp++;
-          current_lamp %= Map::c_unique_lamp_count;
-          break;
+     {
+          Map::Fixture* lamp = map.check_location_for_lamp ( mouse_tile );
+
+          if ( lamp ) {
+               Uint8 index = static_cast<Uint8>( lamp - &map.lamp ( 0 ) );
+               Int32 c = 0;
+
+               while ( c < c_lamp_color_count && c_lamp_colors [ c ] != map.lamp_color ( index ) ) {
+                    c++;
+               }
+
+               map.set_lamp_color ( index, c_lamp_colors [ ( c + 1 ) % c_lamp_color_count ] );
+               map.reset_light ( );
+          } else {
+               current_lamp++;
+               current_lamp %= Map::c_unique_lamp_count;
+          }
+     } break;
      case Mode::exit:
      {
           Interactive& interactive = interactives.get_from_tile ( mouse_tile );
@@ -831,15 +861,8 @@ Void State::render_upgrade ( SDL_Surface* back_buffer )
      SDL_BlitSurface ( upgrade_surface, &src, back_buffer, &dst );
 }
 
-extern "C" Bool game_init ( GameMemory& game_memory, Void* settings )
+static Bool load_surfaces ( State* state, GameMemory& game_memory )
 {
-     MemoryLocations* memory_locations = GAME_PUSH_MEMORY ( game_memory, MemoryLocations );
-     State* state = GAME_PUSH_MEMORY ( game_memory, State);
-
-     state->settings = reinterpret_cast<Settings*>( settings );
-
-     memory_locations->state = state;
-
      if ( !state->text.load_surfaces ( game_memory ) ) {
           return false;
      }
@@ -870,6 +893,40 @@ extern "C" Bool game_init ( GameMemory& game_memory, Void* settings )
           return false;
      }
 
+     return true;
+}
+
+extern "C" Bool game_init ( GameMemory& game_memory, Void* settings )
+{
+     // the editor only keeps its state and scratch for loading files
+     if ( !game_memory.partition ( c_permanent_arena_size ) ) {
+          LOG_ERROR ( "Failed to partition %u bytes of game memory\n", game_memory.size ( ) );
+          return false;
+     }
+
+     MemoryLocations* memory_locations = GAME_PUSH_ARENA_MEMORY ( game_memory, GameMemory::Arena::permanent,
+                                                                  GameMemory::Tag::state, MemoryLocations );
+     State* state = GAME_PUSH_ARENA_MEMORY ( game_memory, GameMemory::Arena::permanent,
+                                            GameMemory::Tag::state, State );
+
+     state->settings = reinterpret_cast<Settings*>( settings );
+
+     memory_locations->state = state;
+
+     if ( !load_surfaces ( state, game_memory ) ) {
+          return false;
+     }
+
+     // lamps placed, and lamps in maps saved without colors, take the region's colors
+     Region region;
+
+     if ( region.load_info ( state->settings->region ) ) {
+          state->map.set_lamp_palette ( region.lamp_colors );
+     } else {
+          LOG_WARNING ( "Lamps will be white without region %d's lamp colors\n", state->settings->region );
+          state->map.set_lamp_palette ( nullptr );
+     }
+
      if ( state->settings->map_load_filename ) {
           if ( !state->settings->map_save_filename ) {
                state->settings->map_save_filename = state->settings->map_load_filename;
@@ -931,6 +988,21 @@ extern "C" Bool game_init ( GameMemory& game_memory, Void* settings )
      return true;
 }
 
+extern "C" Bool game_restore ( GameMemory& game_memory, Void* settings )
+{
+     State* state = get_state ( game_memory );
+
+     state->settings = reinterpret_cast<Settings*>( settings );
+
+     return load_surfaces ( state, game_memory );
+}
+
+extern "C" Bool game_resume ( GameMemory& game_memory )
+{
+     // the editor loads its sheets once and never frees them while running
+     return true;
+}
+
 extern "C" Void game_destroy ( GameMemory& game_memory )
 {
      State* state = get_state ( game_memory );
@@ -1123,8 +1195,18 @@ extern "C" Void game_update ( GameMemory& game_memory, Real32 time_delta )
      case Mode::decor:
           break;
      case Mode::light:
-          sprintf ( state->message_buffer, "BASE %d", state->map.base_light_value ( ) );
-          break;
+     {
+          Map::Fixture* lamp = state->mouse_on_map ( ) ? state->map.check_location_for_lamp ( state->mouse_tile ) :
+                                                         nullptr;
+
+          if ( lamp ) {
+               Uint8 index = static_cast<Uint8>( lamp - &state->map.lamp ( 0 ) );
+               sprintf ( state->message_buffer, "BASE %d COLOR %06X", state->map.base_light_value ( ),
+                         state->map.lamp_color ( index ) );
+          } else {
+               sprintf ( state->message_buffer, "BASE %d", state->map.base_light_value ( ) );
+          }
+     } break;
      case Mode::enemy:
      {
           if ( !state->mouse_on_map ( ) ) {
@@ -1350,7 +1432,7 @@ static Void render_secret ( SDL_Surface* back_buffer, const Map::Secret& secret,
      render_rect_outline ( back_buffer, secret_rect, green_color );
 }
 
-extern "C" Void game_render ( GameMemory& game_memory, SDL_Surface* back_buffer )
+extern "C" Void game_render ( GameMemory& game_memory, SDL_Surface* back_buffer, Real32 interpolation )
 {
      State* state = get_state ( game_memory );
 
@@ -1367,7 +1449,7 @@ extern "C" Void game_render ( GameMemory& game_memory, SDL_Surface* back_buffer
 
      // light
      if ( state->draw_light ) {
-          render_light ( back_buffer, state->map, state->camera.x ( ), state->camera.y ( ) );
+          render_light ( back_buffer, state->map, state->camera.x ( ), state->camera.y ( ), false );
      }
 
      // solids
@@ -35,8 +35,16 @@ Int32 main ( Int32 argc, Char8** argv )
      settings.shared_library_path           = "./bryte_editor.so";
 
      settings.game_memory_allocation_size   = MEGABYTES ( 32 );
+     settings.game_memory_warning_threshold = GameMemory::c_default_warning_threshold;
 
-     settings.locked_frames_per_second      = 30;
+     settings.simulation_frames_per_second  = 30;
+     settings.render_frames_per_second      = 30;
+
+     settings.streaming_back_buffer         = true;
+
+     settings.benchmark_report_path         = nullptr;
+     settings.benchmark_memory_path         = Simulation::c_game_memory_filepath;
+     settings.benchmark_input_path          = Simulation::c_record_input_filepath;
 
      editor::Settings editor_settings;
 
@@ -72,13 +72,14 @@ Void Emitter::setup_limited_time ( const Vector& position, Real32 lifetime, Uint
      lifetime_watch.reset ( lifetime );
 }
 
-Void Emitter::setup_to_track_entity ( Entity* entity, const Vector& entity_offset, Uint32 color,
+Void Emitter::setup_to_track_entity ( const EntityHandle& entity, const Vector& entity_position,
+                                      const Vector& entity_offset, Uint32 color,
                                       Real32 min_particle_angle, Real32 max_particle_angle,
                                       Real32 min_particle_lifetime, Real32 max_particle_lifetime,
                                       Real32 min_particle_speed, Real32 max_particle_speed,
                                       Uint8 particles_per_frame, Uint8 frames_per_particle_batch  )
 {
-     ASSERT ( entity );
+     ASSERT ( !entity.is_null ( ) );
      ASSERT ( min_particle_angle <= max_particle_angle );
      ASSERT ( min_particle_lifetime <= max_particle_lifetime );
      ASSERT ( min_particle_speed <= max_particle_speed );
@@ -103,7 +104,7 @@ Void Emitter::setup_to_track_entity ( Entity* entity, const Vector& entity_offse
      this->track_entity.entity = entity;
      this->track_entity.offset = entity_offset;
 
-     position = track_entity.entity->position + entity_offset;
+     position = entity_position + entity_offset;
 }
 
 Void Emitter::clear ( )
@@ -127,11 +128,11 @@ Void Emitter::clear ( )
      frames_per_particle_batch = 0;
      frames_since_last_batch = 255; // so we always start off spawning particles
 
-     track_entity.entity = nullptr;
+     track_entity.entity = null_entity_handle ( );
      track_entity.offset.zero ( );
 }
 
-Void Emitter::update ( float time_delta, Random& random )
+Void Emitter::update ( float time_delta, Random& random, const Entity* tracked )
 {
      switch ( life_type ) {
      default:
@@ -140,14 +141,15 @@ Void Emitter::update ( float time_delta, Random& random )
      case LifeType::immortal:
           break;
      case LifeType::entity:
-          position = track_entity.entity->position + track_entity.offset;
-
-          if ( track_entity.entity->is_dead ( ) ) {
-               track_entity.entity = nullptr;
+          // the tracked entity died or its slot was reused
+          if ( !tracked ) {
+               track_entity.entity = null_entity_handle ( );
                track_entity.offset.zero ( );
                life_state = Entity::LifeState::dead;
                return;
           }
+
+          position = tracked->position + track_entity.offset;
           break;
      case LifeType::stopwatch:
           lifetime_watch.tick ( time_delta );
@@ -35,7 +35,8 @@ namespace bryte {
                                     Real32 min_particle_speed, Real32 max_particle_speed,
                                     Uint8 particles_per_frame, Uint8 frames_per_particle_batch );
 
-          Void setup_to_track_entity ( Entity* entity, const Vector& entity_offset, Uint32 color,
+          Void setup_to_track_entity ( const EntityHandle& entity, const Vector& entity_position,
+                                       const Vector& entity_offset, Uint32 color,
                                        Real32 min_particle_angle, Real32 max_particle_angle,
                                        Real32 min_particle_lifetime, Real32 max_particle_lifetime,
                                        Real32 min_particle_speed, Real32 max_particle_speed,
@@ -43,7 +44,8 @@ namespace bryte {
 
           Void clear ( );
 
-          Void update ( float time_delta, Random& random );
+          // tracked is what track_entity resolved to this step, nullptr once it is gone
+          Void update ( float time_delta, Random& random, const Entity* tracked );
 
      private:
 
@@ -253,40 +253,58 @@ Void Enemy::init ( Type type, Real32 x, Real32 y, Direction facing, Pickup::Type
      }
 }
 
-Void Enemy::think ( Enemy* enemies, Int32 max_enemies,
-                    const Character& player, Random& random, float time_delta )
+Void Enemy::think_group ( Type type, Enemy** group, Uint32 count, Enemy* enemies, Int32 max_enemies,
+                          const Character& player, Random& random, float time_delta )
 {
      switch ( type )
      {
      default:
           break;
      case Type::rat:
-          rat_think ( player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->rat_think ( player, random, time_delta );
+          }
           break;
      case Type::bat:
-          bat_think ( player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->bat_think ( player, random, time_delta );
+          }
           break;
      case Type::goo:
-          goo_think ( player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->goo_think ( player, random, time_delta );
+          }
           break;
      case Type::skeleton:
-          skeleton_think ( player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->skeleton_think ( player, random, time_delta );
+          }
           break;
      case Type::fairy:
-          fairy_think ( enemies, max_enemies, player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->fairy_think ( enemies, max_enemies, player, random, time_delta );
+          }
           break;
      case Type::knight:
-          knight_think ( player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->knight_think ( player, random, time_delta );
+          }
           break;
      case Type::spike:
-          spike_think ( player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->spike_think ( player, random, time_delta );
+          }
           break;
      case Type::ice_wizard:
-          ice_wizard_think ( player, random, time_delta );
+          for ( Uint32 i = 0; i < count; ++i ) {
+               group [ i ]->ice_wizard_think ( player, random, time_delta );
+          }
           break;
      }
 
-     hit_player = false;
+     for ( Uint32 i = 0; i < count; ++i ) {
+          group [ i ]->hit_player = false;
+     }
 }
 
 Void Enemy::clear ( )
@@ -115,8 +115,9 @@ namespace bryte
 
           Void init ( Type type, Real32 x, Real32 y, Direction facing, Pickup::Type drop );
 
-          Void think ( Enemy* enemies, Int32 max_enemies,
-                       const Character& player, Random& random, float time_delta );
+          // runs one think routine over a group of enemies that are all the given type
+          static Void think_group ( Type type, Enemy** group, Uint32 count, Enemy* enemies, Int32 max_enemies,
+                                    const Character& player, Random& random, float time_delta );
 
           Void clear ( );
 
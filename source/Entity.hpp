@@ -19,7 +19,14 @@ namespace bryte
           inline Bool is_spawning ( ) const;
           inline Bool is_alive ( ) const;
 
+          // blend position between the last 2 simulation steps for rendering, end_interpolation ( )
+          // puts the simulated position back once rendering is done
+          inline Void begin_interpolation ( Real32 interpolation );
+          inline Void end_interpolation ( );
+
           Vector    position;
+          Vector    previous_position;
+          Vector    simulated_position;
           LifeState life_state;
           Element   effected_by_element;
      };
@@ -44,8 +51,58 @@ namespace bryte
           return life_state == LifeState::alive;
      }
 
+     inline Void Entity::begin_interpolation ( Real32 interpolation )
+     {
+          // a tile, no entity moves farther than this in a single step
+          static const Real32 c_max_interpolation_distance = 1.6f;
+
+          simulated_position = position;
+
+          Vector change = position - previous_position;
+
+          // NOTE: don't smear teleports and map transitions across frames
+          if ( change.length_squared ( ) < c_max_interpolation_distance * c_max_interpolation_distance ) {
+               position = previous_position + change * interpolation;
+          }
+     }
+
+     inline Void Entity::end_interpolation ( )
+     {
+          position = simulated_position;
+     }
+
+     // names an entity by pool, slot and the generation of that slot when the handle was made, once
+     // the slot is reused the generations differ and the handle no longer resolves
+     struct EntityHandle {
+          enum Pool {
+               none,
+               player,
+               enemies,
+               pickups,
+               projectiles,
+               bombs,
+               emitters
+          };
+
+          inline Bool is_null ( ) const;
+
+          Uint8  pool;
+          Uint16 index;
+          Uint32 generation;
+     };
+
+     inline Bool EntityHandle::is_null ( ) const
+     {
+          return pool == Pool::none;
+     }
+
+     inline EntityHandle null_entity_handle ( )
+     {
+          return EntityHandle { EntityHandle::Pool::none, 0, 0 };
+     }
+
      struct TrackEntity {
-          Entity* entity;
+          EntityHandle entity;
           Vector offset;
      };
 }
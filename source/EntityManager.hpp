@@ -2,64 +2,254 @@
 #define BRYTE_ENTITY_MANAGER_HPP
 
 #include "Entity.hpp"
+#include "GameMemory.hpp"
 #include "Utils.hpp"
 
 namespace bryte
 {
-     template < typename E, Uint32 MAX >
+     // entities die by setting their own life state, so slots only go back on the free list when
+     // the manager is reaped, once a step or when a spawn finds the free list empty and reap_on_spawn
+     // is set. Until then dead entities are still in the live list and loops over it have to skip them.
+     // Each slot's generation is bumped when it is spawned into, handles made before that go stale.
+     // The capacity is picked at startup, the slots live in the permanent arena so they are part of
+     // any snapshot of game memory
+     template < typename E, EntityHandle::Pool POOL >
      struct EntityManager {
 
+          // takes the slots from the permanent arena, only once before the first clear ( ). tag is the
+          // subsystem the pool's memory is counted under
+          Bool allocate ( GameMemory& game_memory, Uint32 capacity, GameMemory::Tag tag );
+
+          // bytes allocate ( ) pushes for a capacity
+          static Uint32 bytes_for ( Uint32 capacity );
+
+          // nullptr when every slot is live, which is counted in spawn_failures
           E* spawn ( const Vector& position );
 
+          // frees every slot but keeps the generations, so handles from before the clear stay stale
+          // rather than resolving to whatever is spawned into their slot next
           Void clear ( );
 
-          E entities [ MAX ];
+          // move dead entities from the live list to the free list, keeps the live list in order
+          Void reap ( );
+
+          // remember where every entity was at the start of a simulation step
+          Void store_previous_positions ( );
+
+          Void begin_interpolation ( Real32 interpolation );
+          Void end_interpolation ( );
+
+          // handles store the index in 16 bits
+          static const Uint32 c_max_capacity = 65535;
+
+          E* entities;
+          Uint32 capacity;
+
+          // free slots are a stack, live slots are packed in the order they were spawned
+          Uint32* free_slots;
+          Uint32 free_count;
+
+          Uint32* live_slots;
+          Uint32 live_count;
+
+          Uint32* generations;
+
+          // spawns that found the pool full, kept across clears so a whole session can be reported
+          Uint32 spawn_failures;
+
+          // on by default. Pools whose live indices are held through a step, like the ones in a
+          // SpatialGrid, turn it off so the live list only compacts when they are reaped
+          Bool reap_on_spawn;
+
+          // O(1), nullptr if the handle is from another pool, the slot was reused or the entity is dead
+          E* resolve ( const EntityHandle& handle );
+          EntityHandle handle ( const E* entity ) const;
 
           inline E& operator[]( Uint32 i );
 
+          // the i'th entity in the live list
+          inline E& live ( Uint32 i );
+          inline Uint32 live_size ( ) const;
+
           inline Uint32 max ( ) const;
      };
 
-     template < typename E, Uint32 MAX >
-     E* EntityManager<E, MAX>::spawn ( const Vector& position )
+     template < typename E, EntityHandle::Pool POOL >
+     Bool EntityManager<E, POOL>::allocate ( GameMemory& game_memory, Uint32 capacity, GameMemory::Tag tag )
      {
-          for ( Uint32 i = 0; i < MAX; ++i ) {
-               Auto& entity = entities [ i ];
+          if ( capacity == 0 || capacity > c_max_capacity ) {
+               LOG_ERROR ( "Entity pool capacity %u is outside 1 to %u\n", capacity, c_max_capacity );
+               return false;
+          }
+
+          entities = game_memory.push_array<E> ( capacity, GameMemory::Arena::permanent, tag );
+          free_slots = game_memory.push_array<Uint32> ( capacity, GameMemory::Arena::permanent, tag );
+          live_slots = game_memory.push_array<Uint32> ( capacity, GameMemory::Arena::permanent, tag );
+          generations = game_memory.push_array<Uint32> ( capacity, GameMemory::Arena::permanent, tag );
+
+          if ( !entities || !free_slots || !live_slots || !generations ) {
+               return false;
+          }
+
+          this->capacity = capacity;
+          spawn_failures = 0;
+          reap_on_spawn = true;
 
-               if ( entity.is_dead ( ) ) {
-                    entity.life_state = Entity::LifeState::spawning;
-                    entity.effected_by_element = Element::none;
-                    entity.position = position;
-                    return &entity;
+          return true;
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     Uint32 EntityManager<E, POOL>::bytes_for ( Uint32 capacity )
+     {
+          return GameMemory::array_bytes<E> ( capacity ) + GameMemory::array_bytes<Uint32> ( capacity ) * 3;
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     E* EntityManager<E, POOL>::spawn ( const Vector& position )
+     {
+          if ( !free_count ) {
+               if ( reap_on_spawn ) {
+                    reap ( );
+               }
+
+               if ( !free_count ) {
+                    spawn_failures++;
+                    return nullptr;
                }
           }
 
-          return nullptr;
+          Uint32 slot = free_slots [ --free_count ];
+
+          live_slots [ live_count++ ] = slot;
+          generations [ slot ]++;
+
+          Auto& entity = entities [ slot ];
+
+          entity.life_state = Entity::LifeState::spawning;
+          entity.effected_by_element = Element::none;
+          entity.position = position;
+          entity.previous_position = position;
+
+          return &entity;
      }
 
-     template < typename E, Uint32 MAX >
-     Void EntityManager<E, MAX>::clear ( )
+     template < typename E, EntityHandle::Pool POOL >
+     Void EntityManager<E, POOL>::clear ( )
      {
-          for ( Uint32 i = 0; i < MAX; ++i ) {
+          for ( Uint32 i = 0; i < capacity; ++i ) {
                Auto& entity = entities [ i ];
                entity.life_state = Entity::LifeState::dead;
                entity.effected_by_element = Element::none;
                entity.position.set ( 0.0f, 0.0f );
+               entity.previous_position.set ( 0.0f, 0.0f );
                entity.clear ( );
+
+               // slot 0 ends up on top so spawns fill the slots in order
+               free_slots [ i ] = capacity - 1 - i;
+          }
+
+          free_count = capacity;
+          live_count = 0;
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     Void EntityManager<E, POOL>::reap ( )
+     {
+          Uint32 kept = 0;
+
+          for ( Uint32 i = 0; i < live_count; ++i ) {
+               Uint32 slot = live_slots [ i ];
+
+               if ( entities [ slot ].is_dead ( ) ) {
+                    free_slots [ free_count++ ] = slot;
+               } else {
+                    live_slots [ kept++ ] = slot;
+               }
+          }
+
+          live_count = kept;
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     Void EntityManager<E, POOL>::store_previous_positions ( )
+     {
+          for ( Uint32 i = 0; i < live_count; ++i ) {
+               Auto& entity = entities [ live_slots [ i ] ];
+               entity.previous_position = entity.position;
           }
      }
 
-     template < typename E, Uint32 MAX >
-     inline E& EntityManager<E, MAX>::operator[]( Uint32 i )
+     template < typename E, EntityHandle::Pool POOL >
+     Void EntityManager<E, POOL>::begin_interpolation ( Real32 interpolation )
      {
-          ASSERT ( i < MAX );
+          for ( Uint32 i = 0; i < live_count; ++i ) {
+               Auto& entity = entities [ live_slots [ i ] ];
+
+               if ( !entity.is_dead ( ) ) {
+                    entity.begin_interpolation ( interpolation );
+               }
+          }
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     Void EntityManager<E, POOL>::end_interpolation ( )
+     {
+          for ( Uint32 i = 0; i < live_count; ++i ) {
+               Auto& entity = entities [ live_slots [ i ] ];
+
+               if ( !entity.is_dead ( ) ) {
+                    entity.end_interpolation ( );
+               }
+          }
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     E* EntityManager<E, POOL>::resolve ( const EntityHandle& handle )
+     {
+          if ( handle.pool != POOL || handle.index >= capacity ||
+               handle.generation != generations [ handle.index ] ) {
+               return nullptr;
+          }
+
+          E* entity = entities + handle.index;
+
+          return entity->is_dead ( ) ? nullptr : entity;
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     EntityHandle EntityManager<E, POOL>::handle ( const E* entity ) const
+     {
+          ASSERT ( entity >= entities && entity < entities + capacity );
+
+          Uint32 index = static_cast<Uint32>( entity - entities );
+
+          return EntityHandle { POOL, static_cast<Uint16>( index ), generations [ index ] };
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     inline E& EntityManager<E, POOL>::operator[]( Uint32 i )
+     {
+          ASSERT ( i < capacity );
           return entities [ i ];
      }
 
-     template < typename E, Uint32 MAX >
-     inline Uint32 EntityManager<E, MAX>::max ( ) const
+     template < typename E, EntityHandle::Pool POOL >
+     inline E& EntityManager<E, POOL>::live ( Uint32 i )
+     {
+          ASSERT ( i < live_count );
+          return entities [ live_slots [ i ] ];
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     inline Uint32 EntityManager<E, POOL>::live_size ( ) const
+     {
+          return live_count;
+     }
+
+     template < typename E, EntityHandle::Pool POOL >
+     inline Uint32 EntityManager<E, POOL>::max ( ) const
      {
-          return MAX;
+          return capacity;
      }
 
 }
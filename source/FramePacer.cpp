@@ -0,0 +1,165 @@
+#include "FramePacer.hpp"
+#include "Log.hpp"
+
+#ifdef LINUX
+     #include <time.h>
+     #include <errno.h>
+#else
+     #include <chrono>
+     #include <thread>
+#endif
+
+static const Int64 c_nanoseconds_per_second = 1000000000;
+
+static Real64 nanoseconds_to_milliseconds ( Int64 nanoseconds )
+{
+     return static_cast<Real64>( nanoseconds ) / 1000000.0;
+}
+
+FramePacer::FramePacer ( ) :
+     m_interval       ( 0 ),
+     m_next_deadline  ( 0 ),
+     m_previous_frame ( 0 ),
+     m_sample_index   ( 0 ),
+     m_sample_count   ( 0 )
+{
+
+}
+
+Void FramePacer::start ( Uint32 frames_per_second )
+{
+     m_interval       = c_nanoseconds_per_second / frames_per_second;
+     m_previous_frame = now ( );
+     m_next_deadline  = m_previous_frame + m_interval;
+
+     m_sample_index = 0;
+     m_sample_count = 0;
+}
+
+Real64 FramePacer::wait_for_next_frame ( )
+{
+     sleep_until ( m_next_deadline );
+
+     Int64 current_frame = now ( );
+     Int64 elapsed       = current_frame - m_previous_frame;
+
+     m_samples [ m_sample_index ] = elapsed;
+     m_sample_index = ( m_sample_index + 1 ) % c_sample_count;
+
+     if ( m_sample_count < c_sample_count ) {
+          m_sample_count++;
+     }
+
+     m_next_deadline += m_interval;
+
+     // if we fell more than a frame behind, pace from now rather than rushing to catch up
+     if ( m_next_deadline < current_frame ) {
+          m_next_deadline = current_frame + m_interval;
+     }
+
+     m_previous_frame = current_frame;
+
+     return static_cast<Real64>( elapsed ) / static_cast<Real64>( c_nanoseconds_per_second );
+}
+
+FramePacer::Statistics FramePacer::statistics ( ) const
+{
+     Statistics stats {};
+
+     stats.sample_count       = m_sample_count;
+     stats.requested_interval = nanoseconds_to_milliseconds ( m_interval );
+
+     if ( !m_sample_count ) {
+          return stats;
+     }
+
+     Int64 total        = 0;
+     Int64 total_jitter = 0;
+     Int64 min_interval = m_samples [ 0 ];
+     Int64 max_interval = m_samples [ 0 ];
+     Int64 max_jitter   = 0;
+
+     for ( Uint32 i = 0; i < m_sample_count; ++i ) {
+          Int64 sample = m_samples [ i ];
+          Int64 jitter = sample > m_interval ? sample - m_interval : m_interval - sample;
+
+          total        += sample;
+          total_jitter += jitter;
+
+          if ( sample < min_interval ) {
+               min_interval = sample;
+          }
+
+          if ( sample > max_interval ) {
+               max_interval = sample;
+          }
+
+          if ( jitter > max_jitter ) {
+               max_jitter = jitter;
+          }
+
+          if ( sample * 2 > m_interval * 3 ) {
+               stats.missed_count++;
+          }
+     }
+
+     stats.mean_interval = nanoseconds_to_milliseconds ( total / m_sample_count );
+     stats.min_interval  = nanoseconds_to_milliseconds ( min_interval );
+     stats.max_interval  = nanoseconds_to_milliseconds ( max_interval );
+     stats.mean_jitter   = nanoseconds_to_milliseconds ( total_jitter / m_sample_count );
+     stats.max_jitter    = nanoseconds_to_milliseconds ( max_jitter );
+
+     return stats;
+}
+
+Void FramePacer::log_statistics ( ) const
+{
+     Auto stats = statistics ( );
+
+     LOG_INFO ( "Frame pacing over the last %u frames: requested %.3f ms, "
+                "mean %.3f ms, min %.3f ms, max %.3f ms\n",
+                stats.sample_count, stats.requested_interval,
+                stats.mean_interval, stats.min_interval, stats.max_interval );
+     LOG_INFO ( "Frame pacing jitter: mean %.3f ms, max %.3f ms, %u missed frames\n",
+                stats.mean_jitter, stats.max_jitter, stats.missed_count );
+}
+
+Void FramePacer::sleep_until ( Int64 deadline )
+{
+     Int64 sleep_deadline = deadline - c_spin_nanoseconds;
+
+     if ( now ( ) < sleep_deadline ) {
+#ifdef LINUX
+          timespec wake_time;
+
+          wake_time.tv_sec  = sleep_deadline / c_nanoseconds_per_second;
+          wake_time.tv_nsec = sleep_deadline % c_nanoseconds_per_second;
+
+          // absolute deadlines don't drift when we get woken up early by a signal
+          while ( clock_nanosleep ( CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, nullptr ) == EINTR ) {
+          }
+#else
+          std::this_thread::sleep_for ( std::chrono::nanoseconds ( sleep_deadline - now ( ) ) );
+#endif
+     }
+
+     while ( now ( ) < deadline ) {
+          // spin
+     }
+}
+
+Int64 FramePacer::now ( )
+{
+#ifdef LINUX
+     timespec time;
+
+     clock_gettime ( CLOCK_MONOTONIC, &time );
+
+     return static_cast<Int64>( time.tv_sec ) * c_nanoseconds_per_second + time.tv_nsec;
+#else
+     Auto time = std::chrono::steady_clock::now ( ).time_since_epoch ( );
+
+     return std::chrono::duration_cast<std::chrono::nanoseconds>( time ).count ( );
+#endif
+}
+
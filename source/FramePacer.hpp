@@ -0,0 +1,63 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#include "Types.hpp"
+
+// Paces frames to a fixed rate by sleeping until just before each deadline then spinning
+// the rest of the way, tracks how close the actual frame intervals come to the requested one
+class FramePacer {
+public:
+
+     struct Statistics {
+          Uint32 sample_count;
+
+          // all times in milliseconds
+          Real64 requested_interval;
+          Real64 mean_interval;
+          Real64 min_interval;
+          Real64 max_interval;
+
+          // absolute difference between the requested and actual interval
+          Real64 mean_jitter;
+          Real64 max_jitter;
+
+          // frames that took longer than 1.5 intervals
+          Uint32 missed_count;
+     };
+
+     FramePacer ( );
+
+     Void start ( Uint32 frames_per_second );
+
+     // blocks until the next frame is due, returns the seconds elapsed since the previous frame
+     Real64 wait_for_next_frame ( );
+
+     Statistics statistics ( ) const;
+
+     Void log_statistics ( ) const;
+
+private:
+
+     Void sleep_until ( Int64 deadline );
+
+     static Int64 now ( );
+
+private:
+
+     static const Uint32 c_sample_count = 512;
+
+     // sleeping isn't accurate enough for the last stretch before a deadline, spin it instead
+     static const Int64 c_spin_nanoseconds = 1000000;
+
+     Int64  m_interval;
+     Int64  m_next_deadline;
+     Int64  m_previous_frame;
+
+     // ring of actual frame intervals in nanoseconds
+     Int64  m_samples [ c_sample_count ];
+     Uint32 m_sample_index;
+     Uint32 m_sample_count;
+};
+
+#endif
+
@@ -9,7 +9,9 @@ const Char8* c_game_func_strs [ GameFunctions::c_func_count ] = {
     "game_destroy",
     "game_user_input",
     "game_update",
-    "game_render"
+    "game_render",
+    "game_restore",
+    "game_resume"
 };
 
 #else
@@ -25,7 +27,9 @@ GameFunctions::GameFunctions ( ) :
     game_destroy_func ( nullptr ),
     game_user_input_func ( nullptr ),
     game_update_func ( nullptr ),
-    game_render_func ( nullptr )
+    game_render_func ( nullptr ),
+    game_restore_func ( nullptr ),
+    game_resume_func ( nullptr )
 {
 
 }
@@ -84,6 +88,8 @@ Bool GameFunctions::load ( const Char8* shared_library_path )
     game_user_input_func = reinterpret_cast<GameUserInputFunc>( game_funcs [ 2 ] );
     game_update_func = reinterpret_cast<GameUpdateFunc>( game_funcs [ 3 ] );
     game_render_func = reinterpret_cast<GameRenderFunc>( game_funcs [ 4 ] );
+    game_restore_func = reinterpret_cast<GameRestoreFunc>( game_funcs [ 5 ] );
+    game_resume_func = reinterpret_cast<GameResumeFunc>( game_funcs [ 6 ] );
 #else
 
     (Void*)shared_library_path; // unused on windows
@@ -93,6 +99,8 @@ Bool GameFunctions::load ( const Char8* shared_library_path )
     game_user_input_func = game_user_input;
     game_update_func = game_update;
     game_render_func = game_render;
+    game_restore_func = game_restore;
+    game_resume_func = game_resume;
 #endif
 
     return true;
@@ -12,7 +12,9 @@ extern "C" Bool game_init_stub       ( GameMemory&, Void* settings );
 extern "C" Void game_destroy_stub    ( GameMemory& );
 extern "C" Void game_user_input_stub ( GameMemory&, const GameInput& );
 extern "C" Void game_update_stub     ( GameMemory&, Real32 );
-extern "C" Void game_render_stub     ( GameMemory&, SDL_Surface* );
+extern "C" Void game_render_stub     ( GameMemory&, SDL_Surface*, Real32 interpolation );
+extern "C" Bool game_restore_stub    ( GameMemory&, Void* settings );
+extern "C" Bool game_resume_stub     ( GameMemory& );
 
 // exported function types
 using GameInitFunc         = decltype ( game_init_stub )*;
@@ -20,6 +22,8 @@ using GameDestroyFunc      = decltype ( game_destroy_stub )*;
 using GameUserInputFunc    = decltype ( game_user_input_stub )*;
 using GameUpdateFunc       = decltype ( game_update_stub )*;
 using GameRenderFunc       = decltype ( game_render_stub )*;
+using GameRestoreFunc      = decltype ( game_restore_stub )*;
+using GameResumeFunc       = decltype ( game_resume_stub )*;
 
 struct GameFunctions
 {
@@ -32,7 +36,7 @@ struct GameFunctions
     Void* shared_library_handle;
     Char8* shared_library_filepath;
 
-    static const Int32 c_func_count = 5;
+    static const Int32 c_func_count = 7;
 #endif
 
     GameInitFunc      game_init_func;
@@ -40,6 +44,8 @@ struct GameFunctions
     GameUserInputFunc game_user_input_func;
     GameUpdateFunc    game_update_func;
     GameRenderFunc    game_render_func;
+    GameRestoreFunc   game_restore_func;
+    GameResumeFunc    game_resume_func;
 };
 
 #endif
@@ -4,22 +4,101 @@
 #include "Types.hpp"
 #include "Utils.hpp"
 
+#include <cstring>
+
 #define GAME_PUSH_MEMORY(appMem, type) reinterpret_cast<type*>( appMem.push( sizeof ( type ) ) )
 #define GAME_POP_MEMORY(appMem, type) appMem.pop( sizeof ( type ) )
 
 #define GAME_PUSH_MEMORY_ARRAY(appMem, type, count) reinterpret_cast<type*>( appMem.push( sizeof ( type ) * count ) )
 #define GAME_POP_MEMORY_ARRAY(appMem, type, count) appMem.pop( sizeof ( type ) * count )
 
+#define GAME_PUSH_ARENA_MEMORY(appMem, arena, tag, type) reinterpret_cast<type*>( appMem.push( sizeof ( type ), arena, tag ) )
+#define GAME_PUSH_ARENA_MEMORY_ARRAY(appMem, arena, tag, type, count) reinterpret_cast<type*>( appMem.push( sizeof ( type ) * count, arena, tag ) )
+#define GAME_POP_ARENA_MEMORY_ARRAY(appMem, arena, tag, type, count) appMem.pop( sizeof ( type ) * count, arena, tag )
+
+// NOTE: the arena table is kept at the start of the memory it describes, so a snapshot of the memory
+//       restores it along with everything else
 class GameMemory {
 public:
 
+     // permanent lives as long as the game, frame is scratch the platform releases before every
+     // update and render
+     enum Arena {
+          permanent,
+          frame,
+          count
+     };
+
+     // which subsystem a push is for, usage is tracked per tag
+     enum Tag {
+          untagged,
+          state,
+          enemies,
+          pickups,
+          projectiles,
+          bombs,
+          emitters,
+          spatial_grid,
+          file,
+          tag_count
+     };
+
+     // a point in an arena to roll back to
+     struct Marker {
+          Arena  arena;
+          Uint32 used;
+          Uint32 tag_used [ Tag::tag_count ];
+     };
+
+     struct Usage {
+          Uint32 used;
+          Uint32 capacity;
+
+          // most ever used, and most used since the platform started the last frame
+          Uint32 high_water;
+          Uint32 frame_high_water;
+     };
+
+     // rolls an arena back to where it was when the scope began
+     class ScopedMarker {
+     public:
+
+          inline ScopedMarker ( GameMemory& game_memory, Arena arena );
+          inline ~ScopedMarker ( );
+
+     private:
+
+          GameMemory& m_game_memory;
+          Marker      m_marker;
+     };
+
      inline GameMemory ( Void* location = nullptr, Uint32 size = 0 );
 
+     // split the memory into arenas, frame takes whatever permanent leaves. Only while they are empty
+     inline Bool partition ( Uint32 permanent_capacity );
+
      // push memory segment
-     inline Void* push ( Uint32 size );
+     inline Void* push ( Uint32 size, Arena arena = permanent, Tag tag = untagged );
 
      // return memory segment
-     inline Void pop ( Uint32 size );
+     inline Void pop ( Uint32 size, Arena arena = permanent, Tag tag = untagged );
+
+     // pushes count zeroed Ts, padded so whatever is pushed next stays aligned for any of them
+     template < typename T >
+     inline T* push_array ( Uint32 count, Arena arena = permanent, Tag tag = untagged );
+
+     // bytes push_array ( ) takes for count Ts
+     template < typename T >
+     static inline Uint32 array_bytes ( Uint32 count );
+
+     inline Marker marker ( Arena arena ) const;
+     inline Void rollback ( const Marker& marker );
+
+     // release everything in an arena
+     inline Void reset ( Arena arena );
+
+     // release the frame arena and start tracking a new frame's high water marks
+     inline Void begin_frame ( );
 
      // clear memory pointer and return it
      inline Void clear ( );
@@ -27,46 +106,266 @@ public:
      // accessor for the location of our memory
      inline Void* location ( );
 
+     // where an arena's first push lands
+     inline Void* arena_location ( Arena arena );
+
      inline Uint32 size ( ) const;
 
+     // how many bytes from the start of memory hold anything that outlives a frame
+     inline Uint32 used ( ) const;
+
+     inline Uint32 used ( Arena arena ) const;
+     inline Uint32 capacity ( Arena arena ) const;
+
+     inline Usage usage ( Arena arena ) const;
+     inline Uint32 tag_used ( Tag tag ) const;
+     inline Uint32 tag_high_water ( Tag tag ) const;
+
+     // percent of an arena's capacity that logs a warning the first time a push crosses it
+     inline Void set_warning_threshold ( Uint32 percent );
+
+     // bytes at the start of memory the arena table takes before the first arena
+     static inline Uint32 table_bytes ( );
+
+     static inline const Char8* arena_name ( Arena arena );
+     static inline const Char8* tag_name ( Tag tag );
+
+public:
+
+     static const Uint32 c_default_warning_threshold = 90;
+
+private:
+
+     struct ArenaTable {
+          Uint32 offset           [ Arena::count ];
+          Uint32 capacity         [ Arena::count ];
+          Uint32 used             [ Arena::count ];
+          Uint32 high_water       [ Arena::count ];
+          Uint32 frame_high_water [ Arena::count ];
+          Bool   warned           [ Arena::count ];
+
+          Uint32 tag_used         [ Arena::count ] [ Tag::tag_count ];
+          Uint32 tag_high_water   [ Tag::tag_count ];
+
+          Uint32 warning_threshold;
+     };
+
+     static const Uint32 c_arena_alignment = 16;
+     static const Uint32 c_array_alignment = 8;
+
+     static inline Uint32 align ( Uint32 offset );
+
+     inline ArenaTable* table ( ) const;
+
+     inline Void check_warning_threshold ( Arena arena, Tag tag );
+
 private:
 
      Void*  m_memory;
      Uint32 m_size;
-     Uint32 m_used;
 };
 
+inline GameMemory::ScopedMarker::ScopedMarker ( GameMemory& game_memory, Arena arena ) :
+     m_game_memory ( game_memory ),
+     m_marker      ( game_memory.marker ( arena ) )
+{
+
+}
+
+inline GameMemory::ScopedMarker::~ScopedMarker ( )
+{
+     m_game_memory.rollback ( m_marker );
+}
+
 inline GameMemory::GameMemory ( Void* location, Uint32 size ) :
      m_memory ( location ),
-     m_size ( size ),
-     m_used ( 0 )
+     m_size ( size )
 {
+     if ( !m_memory ) {
+          return;
+     }
+
+     ASSERT ( size > sizeof ( ArenaTable ) );
+
+     // until the game partitions it, everything is permanent
+     Uint32 start = align ( sizeof ( ArenaTable ) );
+     ArenaTable* arenas = table ( );
+
+     for ( Uint32 i = 0; i < Arena::count; ++i ) {
+          arenas->offset [ i ]           = m_size;
+          arenas->capacity [ i ]         = 0;
+          arenas->used [ i ]             = 0;
+          arenas->high_water [ i ]       = 0;
+          arenas->frame_high_water [ i ] = 0;
+          arenas->warned [ i ]           = false;
+
+          for ( Uint32 t = 0; t < Tag::tag_count; ++t ) {
+               arenas->tag_used [ i ] [ t ] = 0;
+          }
+     }
+
+     for ( Uint32 t = 0; t < Tag::tag_count; ++t ) {
+          arenas->tag_high_water [ t ] = 0;
+     }
+
+     arenas->offset [ Arena::permanent ]   = start;
+     arenas->capacity [ Arena::permanent ] = m_size - start;
+
+     arenas->warning_threshold = c_default_warning_threshold;
+}
+
+inline Bool GameMemory::partition ( Uint32 permanent_capacity )
+{
+     ArenaTable* arenas = table ( );
+
+     for ( Uint32 i = 0; i < Arena::count; ++i ) {
+          if ( arenas->used [ i ] ) {
+               return false;
+          }
+     }
+
+     Uint32 capacities [ Arena::count ] = { permanent_capacity, 0 };
+     Uint32 offset = align ( sizeof ( ArenaTable ) );
+
+     for ( Uint32 i = 0; i < Arena::frame; ++i ) {
+          arenas->offset [ i ]   = offset;
+          arenas->capacity [ i ] = capacities [ i ];
+
+          offset = align ( offset + capacities [ i ] );
 
+          if ( offset >= m_size ) {
+               return false;
+          }
+     }
+
+     arenas->offset [ Arena::frame ]   = offset;
+     arenas->capacity [ Arena::frame ] = m_size - offset;
+
+     return true;
 }
 
-inline Void* GameMemory::push ( Uint32 size )
+inline Void* GameMemory::push ( Uint32 size, Arena arena, Tag tag )
 {
-     ASSERT ( ( m_used + size ) < m_size );
+     ArenaTable* arenas = table ( );
+
+     if ( ( arenas->used [ arena ] + size ) > arenas->capacity [ arena ] ) {
+          LOG_ERROR ( "%s arena out of memory pushing %u bytes of %s, %u of %u bytes used\n",
+                      arena_name ( arena ), size, tag_name ( tag ),
+                      arenas->used [ arena ], arenas->capacity [ arena ] );
+          ASSERT ( 0 );
+          return nullptr;
+     }
+
+     Void* ptr = reinterpret_cast<Char8*>( m_memory ) + arenas->offset [ arena ] + arenas->used [ arena ];
+
+     arenas->used [ arena ] += size;
+     arenas->tag_used [ arena ] [ tag ] += size;
 
-     Void* ptr = reinterpret_cast<Char8*>( m_memory ) + m_used;
+     if ( arenas->used [ arena ] > arenas->high_water [ arena ] ) {
+          arenas->high_water [ arena ] = arenas->used [ arena ];
+     }
 
-     m_used += size;
+     if ( arenas->used [ arena ] > arenas->frame_high_water [ arena ] ) {
+          arenas->frame_high_water [ arena ] = arenas->used [ arena ];
+     }
+
+     Uint32 tag_total = tag_used ( tag );
+
+     if ( tag_total > arenas->tag_high_water [ tag ] ) {
+          arenas->tag_high_water [ tag ] = tag_total;
+     }
+
+     check_warning_threshold ( arena, tag );
 
      return ptr;
 }
 
-inline Void GameMemory::pop ( Uint32 size )
+inline Void GameMemory::pop ( Uint32 size, Arena arena, Tag tag )
 {
-     ASSERT ( size <= m_used );
+     ArenaTable* arenas = table ( );
 
-     m_used -= size;
+     ASSERT ( size <= arenas->used [ arena ] );
+     ASSERT ( size <= arenas->tag_used [ arena ] [ tag ] );
+
+     arenas->used [ arena ] -= size;
+     arenas->tag_used [ arena ] [ tag ] -= size;
+}
+
+template < typename T >
+inline T* GameMemory::push_array ( Uint32 count, Arena arena, Tag tag )
+{
+     static_assert ( alignof ( T ) <= c_array_alignment, "push_array ( ) only keeps 8 byte alignment" );
+
+     Uint32 size = array_bytes<T> ( count );
+     Void* ptr = push ( size, arena, tag );
+
+     if ( ptr ) {
+          memset ( ptr, 0, size );
+     }
+
+     return reinterpret_cast<T*>( ptr );
+}
+
+template < typename T >
+inline Uint32 GameMemory::array_bytes ( Uint32 count )
+{
+     return ( static_cast<Uint32>( sizeof ( T ) ) * count + c_array_alignment - 1 ) & ~( c_array_alignment - 1 );
+}
+
+inline GameMemory::Marker GameMemory::marker ( Arena arena ) const
+{
+     ArenaTable* arenas = table ( );
+     Marker marker;
+
+     marker.arena = arena;
+     marker.used  = arenas->used [ arena ];
+
+     for ( Uint32 t = 0; t < Tag::tag_count; ++t ) {
+          marker.tag_used [ t ] = arenas->tag_used [ arena ] [ t ];
+     }
+
+     return marker;
+}
+
+inline Void GameMemory::rollback ( const Marker& marker )
+{
+     ArenaTable* arenas = table ( );
+
+     ASSERT ( marker.used <= arenas->used [ marker.arena ] );
+
+     arenas->used [ marker.arena ] = marker.used;
+
+     for ( Uint32 t = 0; t < Tag::tag_count; ++t ) {
+          arenas->tag_used [ marker.arena ] [ t ] = marker.tag_used [ t ];
+     }
+}
+
+inline Void GameMemory::reset ( Arena arena )
+{
+     ArenaTable* arenas = table ( );
+
+     arenas->used [ arena ] = 0;
+
+     for ( Uint32 t = 0; t < Tag::tag_count; ++t ) {
+          arenas->tag_used [ arena ] [ t ] = 0;
+     }
+}
+
+inline Void GameMemory::begin_frame ( )
+{
+     reset ( Arena::frame );
+
+     ArenaTable* arenas = table ( );
+
+     for ( Uint32 i = 0; i < Arena::count; ++i ) {
+          arenas->frame_high_water [ i ] = arenas->used [ i ];
+     }
 }
 
 inline Void GameMemory::clear ( )
 {
      m_memory = nullptr;
      m_size   = 0;
-     m_used   = 0;
 }
 
 inline Void* GameMemory::location ( )
@@ -74,10 +373,140 @@ inline Void* GameMemory::location ( )
      return m_memory;
 }
 
+inline Void* GameMemory::arena_location ( Arena arena )
+{
+     return reinterpret_cast<Char8*>( m_memory ) + table ( )->offset [ arena ];
+}
+
 inline Uint32 GameMemory::size ( ) const
 {
      return m_size;
 }
 
+inline Uint32 GameMemory::used ( ) const
+{
+     if ( !m_memory ) {
+          return 0;
+     }
+
+     ArenaTable* arenas = table ( );
+     Uint32 end = sizeof ( ArenaTable );
+
+     // frame memory never outlives the call that pushed it, so it is left out
+     for ( Uint32 i = 0; i < Arena::frame; ++i ) {
+          if ( arenas->used [ i ] && arenas->offset [ i ] + arenas->used [ i ] > end ) {
+               end = arenas->offset [ i ] + arenas->used [ i ];
+          }
+     }
+
+     return end;
+}
+
+inline Uint32 GameMemory::used ( Arena arena ) const
+{
+     return table ( )->used [ arena ];
+}
+
+inline Uint32 GameMemory::capacity ( Arena arena ) const
+{
+     return table ( )->capacity [ arena ];
+}
+
+inline GameMemory::Usage GameMemory::usage ( Arena arena ) const
+{
+     ArenaTable* arenas = table ( );
+     Usage usage;
+
+     usage.used             = arenas->used [ arena ];
+     usage.capacity         = arenas->capacity [ arena ];
+     usage.high_water       = arenas->high_water [ arena ];
+     usage.frame_high_water = arenas->frame_high_water [ arena ];
+
+     return usage;
+}
+
+inline Uint32 GameMemory::tag_used ( Tag tag ) const
+{
+     ArenaTable* arenas = table ( );
+     Uint32 total = 0;
+
+     for ( Uint32 i = 0; i < Arena::count; ++i ) {
+          total += arenas->tag_used [ i ] [ tag ];
+     }
+
+     return total;
+}
+
+inline Uint32 GameMemory::tag_high_water ( Tag tag ) const
+{
+     return table ( )->tag_high_water [ tag ];
+}
+
+inline Void GameMemory::set_warning_threshold ( Uint32 percent )
+{
+     table ( )->warning_threshold = percent;
+}
+
+inline Uint32 GameMemory::table_bytes ( )
+{
+     return align ( sizeof ( ArenaTable ) );
+}
+
+inline const Char8* GameMemory::arena_name ( Arena arena )
+{
+     static const Char8* names [ Arena::count ] = {
+          "permanent",
+          "frame"
+     };
+
+     return names [ arena ];
+}
+
+inline const Char8* GameMemory::tag_name ( Tag tag )
+{
+     static const Char8* names [ Tag::tag_count ] = {
+          "untagged",
+          "state",
+          "enemies",
+          "pickups",
+          "projectiles",
+          "bombs",
+          "emitters",
+          "spatial_grid",
+          "file"
+     };
+
+     return names [ tag ];
+}
+
+inline Uint32 GameMemory::align ( Uint32 offset )
+{
+     return ( offset + c_arena_alignment - 1 ) & ~( c_arena_alignment - 1 );
+}
+
+inline GameMemory::ArenaTable* GameMemory::table ( ) const
+{
+     return reinterpret_cast<ArenaTable*>( m_memory );
+}
+
+inline Void GameMemory::check_warning_threshold ( Arena arena, Tag tag )
+{
+     ArenaTable* arenas = table ( );
+
+     Uint64 used_percent = static_cast<Uint64>( arenas->used [ arena ] ) * 100;
+     Uint64 threshold    = static_cast<Uint64>( arenas->capacity [ arena ] ) * arenas->warning_threshold;
+
+     // warn once per crossing, releasing below the threshold re-arms it
+     if ( used_percent < threshold ) {
+          arenas->warned [ arena ] = false;
+     } else if ( !arenas->warned [ arena ] ) {
+          arenas->warned [ arena ] = true;
+
+          LOG_WARNING ( "%s arena passed %u%% of its %u bytes pushing %s, %u bytes used\n",
+                        arena_name ( arena ), arenas->warning_threshold,
+                        arenas->capacity [ arena ], tag_name ( tag ), arenas->used [ arena ] );
+     }
+}
+
 #endif
 
@@ -1,11 +1,17 @@
 #include "InputRecorder.hpp"
 #include "Utils.hpp"
 
+#include <cstring>
+
+#ifdef LINUX
+     #include <unistd.h>
+#endif
+
 InputRecorder::InputRecorder ( ) :
      m_recording    ( false ),
      m_playing_back ( false )
 {
-
+     m_path [ 0 ] = '\0';
 }
 
 Bool InputRecorder::start_recording ( const Char8* path )
@@ -22,6 +28,9 @@ Bool InputRecorder::start_recording ( const Char8* path )
           return false;
      }
 
+     strncpy ( m_path, path, c_max_path_length - 1 );
+     m_path [ c_max_path_length - 1 ] = '\0';
+
      m_recording = true;
 
      return true;
@@ -34,8 +43,18 @@ Bool InputRecorder::stop_recording ( )
 
      LOG_INFO ( "Done recording input.\n" );
 
+     Uint64 end = position ( );
+
      m_file.close ( );
 
+#ifdef LINUX
+     // a rewind while recording leaves frames past the end that were never played
+     if ( truncate ( m_path, end ) ) {
+          LOG_WARNING ( "Failed to truncate recorded input '%s' to %llu bytes.\n", m_path,
+                        static_cast<unsigned long long>( end ) );
+     }
+#endif
+
      m_recording = false;
 
      return true;
@@ -100,15 +119,6 @@ Bool InputRecorder::read_frame ( GameInput& game_input )
      ASSERT ( !m_recording );
      ASSERT ( m_playing_back );
 
-     bool reached_eof = false;
-
-     if ( m_file.eof ( ) ) {
-          m_file.clear ( );
-          m_file.seekg ( m_file.beg );
-
-          reached_eof = true;
-     }
-
      m_file.read ( reinterpret_cast<Char8*> ( &game_input.key_change_count ),
                    sizeof ( game_input.key_change_count ) );
      m_file.read ( reinterpret_cast<Char8*> ( game_input.key_changes ),
@@ -124,6 +134,47 @@ Bool InputRecorder::read_frame ( GameInput& game_input )
      m_file.read ( reinterpret_cast<Char8*> ( &game_input.mouse_position_y ),
                    sizeof ( game_input.mouse_position_y ) );
 
-     return !reached_eof;
+     // at the end of the recording, rewind for the next read and hand back no input
+     if ( !m_file ) {
+          m_file.clear ( );
+          m_file.seekg ( 0, m_file.beg );
+
+          game_input.reset ( );
+
+          return false;
+     }
+
+     return true;
 }
 
+Uint64 InputRecorder::position ( )
+{
+     if ( m_recording ) {
+          return static_cast<Uint64>( m_file.tellp ( ) );
+     }
+
+     if ( m_playing_back ) {
+          return static_cast<Uint64>( m_file.tellg ( ) );
+     }
+
+     return 0;
+}
+
+Bool InputRecorder::seek ( Uint64 position )
+{
+     if ( m_recording ) {
+          m_file.seekp ( position, m_file.beg );
+     } else if ( m_playing_back ) {
+          m_file.clear ( );
+          m_file.seekg ( position, m_file.beg );
+     } else {
+          return false;
+     }
+
+     if ( !m_file ) {
+          LOG_ERROR ( "Failed to seek recorded input to %llu.\n", static_cast<unsigned long long>( position ) );
+          return false;
+     }
+
+     return true;
+}
@@ -18,13 +18,21 @@ public:
      Void write_frame ( const GameInput& game_input );
      Bool read_frame ( GameInput& game_input );
 
+     // where the next frame will be written or read, seeking while recording drops what follows
+     Uint64 position ( );
+     Bool seek ( Uint64 position );
+
      inline Bool is_recording ( ) const;
      inline Bool is_playing_back ( ) const;
 
 private:
 
+     static const Uint32 c_max_path_length = 256;
+
      std::fstream m_file;
 
+     Char8 m_path [ c_max_path_length ];
+
      Bool m_recording;
      Bool m_playing_back;
 
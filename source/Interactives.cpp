@@ -51,7 +51,11 @@ Interactive& Interactives::get_from_tile ( const Location& tile )
      ASSERT ( tile.x >= 0 && tile.x < m_width );
      ASSERT ( tile.y >= 0 && tile.y < m_height );
 
-     return m_interactives [ ( tile.y * m_width ) + tile.x ];
+     Int32 index = ( tile.y * m_width ) + tile.x;
+
+     tile_changed ( index );
+
+     return m_interactives [ index ];
 }
 
 const Interactive& Interactives::cget_from_tile ( const Location& tile ) const
@@ -73,6 +77,10 @@ Void Interactives::reset ( Int32 width, Int32 height )
           m_interactives [ i ].type = Interactive::Type::none;
           m_interactives [ i ].underneath.type = UnderneathInteractive::Type::none;
      }
+
+     for ( Int32 i = 0; i < c_stale_word_count; ++i ) {
+          m_stale_tiles [ i ] = ~0ull;
+     }
 }
 
 Interactive& Interactives::add ( Interactive::Type type, const Location& tile )
@@ -86,24 +94,35 @@ Interactive& Interactives::add ( Interactive::Type type, const Location& tile )
      return i;
 }
 
-Void Interactives::contribute_light ( Map& map )
+// lit torches give off warm light, icy ones tint without counting as light so detectors ignore them
+static Void contribute_torch_light ( const Torch& torch, const Location& tile, Map& map )
+{
+     switch ( torch.element ) {
+     default:
+          break;
+     case Element::fire:
+          map.add_light ( tile, torch.value, Map::c_fire_light );
+          break;
+     case Element::ice:
+          map.add_light ( tile, torch.value, Map::c_ice_light );
+          break;
+     }
+}
+
+Void Interactives::contribute_light ( Map& map ) const
 {
      for ( Location tile; tile.y < height ( ); ++tile.y ) {
           for ( tile.x = 0; tile.x < width ( ); ++tile.x ) {
-               Auto& interactive = get_from_tile ( tile );
+               const Auto& interactive = cget_from_tile ( tile );
 
                switch ( interactive.type ) {
                default:
                     break;
                case Interactive::Type::torch:
-                    if ( interactive.interactive_torch.element == Element::fire ) {
-                         map.illuminate ( tile, interactive.interactive_torch.value );
-                    }
+                    contribute_torch_light ( interactive.interactive_torch, tile, map );
                     break;
                case Interactive::Type::pushable_torch:
-                    if ( interactive.interactive_pushable_torch.torch.element == Element::fire ) {
-                         map.illuminate ( tile, interactive.interactive_pushable_torch.torch.value );
-                    }
+                    contribute_torch_light ( interactive.interactive_pushable_torch.torch, tile, map );
                     break;
                }
           }
@@ -309,24 +328,55 @@ Void Interactives::spread_ice ( const Location& tile, const Map& map, bool clear
 
 Bool Interactives::is_walkable ( const Location& tile, Direction dir ) const
 {
-     const Auto& interactive = cget_from_tile ( tile );
+     ASSERT ( tile.x >= 0 && tile.x < m_width );
+     ASSERT ( tile.y >= 0 && tile.y < m_height );
+
+     Uint8 flags = tile_flags ( tile );
+
+     if ( flags & c_portal_flag ) {
+          Auto dest_tile = tile;
+
+          get_portal_destination ( &dest_tile, dir );
+
+          return is_walkable ( dest_tile, dir );
+     }
+
+     return flags & c_walkable_flag;
+}
+
+Bool Interactives::is_flyable ( const Location& tile ) const
+{
+     ASSERT ( tile.x >= 0 && tile.x < m_width );
+     ASSERT ( tile.y >= 0 && tile.y < m_height );
+
+     return tile_flags ( tile ) & c_flyable_flag;
+}
+
+Uint8 Interactives::calculate_tile_flags ( const Interactive& interactive ) const
+{
+     Uint8 flags = c_flyable_flag;
+
+     if ( interactive.type == Interactive::Type::exit ||
+          interactive.underneath.type == UnderneathInteractive::Type::destructable ) {
+          flags = 0;
+     }
 
      switch ( interactive.underneath.type ) {
      default:
           break;
      case UnderneathInteractive::Type::popup_block:
           if ( interactive.underneath.underneath_popup_block.up ) {
-               return false;
+               return flags;
           }
           break;
      case UnderneathInteractive::Type::hole:
           if ( !interactive.underneath.underneath_hole.filled ) {
-               return false;
+               return flags;
           }
           break;
      case UnderneathInteractive::Type::destructable:
           if ( !interactive.underneath.underneath_destructable.destroyed ) {
-               return false;
+               return flags;
           }
           break;
      }
@@ -339,41 +389,17 @@ Bool Interactives::is_walkable ( const Location& tile, Direction dir ) const
      case Interactive::Type::torch:
      case Interactive::Type::pushable_torch:
      case Interactive::Type::bombable_block:
-          return false;
+          return flags;
      case Interactive::Type::exit:
-          return interactive.interactive_exit.state == Exit::State::open;
-     case Interactive::Type::portal:
-     {
-          Auto dest_tile = tile;
-
-          get_portal_destination ( &dest_tile, dir );
-
-          return is_walkable ( dest_tile, dir );
-     } break;
-     }
-
-     return true;
-}
-
-Bool Interactives::is_flyable ( const Location& tile ) const
-{
-     const Auto& interactive = cget_from_tile ( tile );
-
-     switch ( interactive.type ) {
-     default:
-          break;
-     case Interactive::Type::exit:
-          return false;
-     }
-
-     switch ( interactive.underneath.type ) {
-     default:
+          if ( interactive.interactive_exit.state != Exit::State::open ) {
+               return flags;
+          }
           break;
-     case UnderneathInteractive::Type::destructable:
-          return false;;
+     case Interactive::Type::portal:
+          return flags | c_portal_flag;
      }
 
-     return true;
+     return flags | c_walkable_flag;
 }
 
 Void Interactive::reset ( )
@@ -276,7 +276,8 @@ namespace bryte
 
           Interactive& add ( Interactive::Type type, const Location& tile );
 
-          Void contribute_light ( Map& map );
+          // adds torches on fire to the light being built between Map::begin_light ( ) and end_light ( )
+          Void contribute_light ( Map& map ) const;
 
           Bool push ( const Location& tile, Direction dir, const Map& map );
           Bool activate ( const Location& tile );
@@ -294,9 +295,13 @@ namespace bryte
 
           Void get_portal_destination ( Location* dest_tile, Direction dir ) const;
 
+          // hands out a mutable interactive, so its tile's cached walkable and flyable bits are rebuilt
           Interactive& get_from_tile ( const Location& tile );
           const Interactive& cget_from_tile ( const Location& tile ) const;
 
+          // for changes made without going through get_from_tile ( )
+          inline Void tile_changed ( Int32 index );
+
           inline Int32 width ( ) const;
           inline Int32 height ( ) const;
 
@@ -306,16 +311,32 @@ namespace bryte
                                              Location* dest_tile,
                                              Direction dir ) const;
 
+          inline Uint8 tile_flags ( const Location& tile ) const;
+          Uint8 calculate_tile_flags ( const Interactive& interactive ) const;
+
      public:
 
           static const Int32 c_max_interactives = Map::c_max_tiles;
 
+          static const Uint8 c_walkable_flag = 1;
+          static const Uint8 c_flyable_flag  = 2;
+          static const Uint8 c_portal_flag   = 4; // walkability depends on the destination, never cached
+
+          static const Int32 c_stale_word_count = ( c_max_interactives + 63 ) / 64;
+
      public:
 
           Interactive m_interactives [ c_max_interactives ];
 
           Int32 m_width;
           Int32 m_height;
+
+     private:
+
+          // characters and projectiles check these every frame, the bits are rebuilt lazily
+          // for tiles marked stale
+          mutable Uint8  m_tile_flags [ c_max_interactives ];
+          mutable Uint64 m_stale_tiles [ c_stale_word_count ];
      };
 
      inline Int32 Interactives::width ( ) const
@@ -327,6 +348,24 @@ namespace bryte
      {
           return m_height;
      }
+
+     inline Void Interactives::tile_changed ( Int32 index )
+     {
+          m_stale_tiles [ index / 64 ] |= 1ull << ( index % 64 );
+     }
+
+     inline Uint8 Interactives::tile_flags ( const Location& tile ) const
+     {
+          Int32 index = ( tile.y * m_width ) + tile.x;
+          Uint64 bit = 1ull << ( index % 64 );
+
+          if ( m_stale_tiles [ index / 64 ] & bit ) {
+               m_tile_flags [ index ] = calculate_tile_flags ( m_interactives [ index ] );
+               m_stale_tiles [ index / 64 ] &= ~bit;
+          }
+
+          return m_tile_flags [ index ];
+     }
 }
 
 #endif
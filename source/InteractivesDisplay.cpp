@@ -2,6 +2,7 @@
 #include "Map.hpp"
 #include "GameMemory.hpp"
 #include "Bitmap.hpp"
+#include "Profiler.hpp"
 
 using namespace bryte;
 
@@ -145,6 +146,8 @@ Void InteractivesDisplay::tick ( )
 Void InteractivesDisplay::render ( SDL_Surface* back_buffer, Interactives& interactives,
                                    const Map& map, Real32 camera_x, Real32 camera_y, Bool invisible )
 {
+     PROFILE_ZONE ( "InteractivesDisplay::render" );
+
      if ( invisible ) {
           for ( Int32 y = 0; y < interactives.height ( ); ++y ) {
                for ( Int32 x = 0; x < interactives.width ( ); ++x ) {
@@ -153,7 +156,7 @@ Void InteractivesDisplay::render ( SDL_Surface* back_buffer, Interactives& inter
 
                     Map::convert_tiles_to_pixels ( &position );
 
-                    Auto& interactive = interactives.get_from_tile ( tile );
+                    const Auto& interactive = interactives.cget_from_tile ( tile );
 
                     SDL_Rect dest_rect { position.x, position.y,
                                          Map::c_tile_dimension_in_pixels, Map::c_tile_dimension_in_pixels };
@@ -177,7 +180,7 @@ Void InteractivesDisplay::render ( SDL_Surface* back_buffer, Interactives& inter
 
                     Map::convert_tiles_to_pixels ( &position );
 
-                    Auto& interactive = interactives.get_from_tile ( tile );
+                    const Auto& interactive = interactives.cget_from_tile ( tile );
 
                     SDL_Rect dest_rect { position.x, position.y,
                                          Map::c_tile_dimension_in_pixels, Map::c_tile_dimension_in_pixels };
@@ -191,7 +194,7 @@ Void InteractivesDisplay::render ( SDL_Surface* back_buffer, Interactives& inter
      }
 }
 
-Void InteractivesDisplay::render_underneath ( SDL_Surface* back_buffer, UnderneathInteractive& underneath,
+Void InteractivesDisplay::render_underneath ( SDL_Surface* back_buffer, const UnderneathInteractive& underneath,
                                               SDL_Rect* dest_rect )
 {
      SDL_Rect clip_rect { 0, 0,
@@ -264,7 +267,7 @@ Void InteractivesDisplay::render_underneath ( SDL_Surface* back_buffer, Undernea
      SDL_BlitSurface ( underneath_sheet, &clip_rect, back_buffer, dest_rect );
 }
 
-Void InteractivesDisplay::render_interactive ( SDL_Surface* back_buffer, Interactive& interactive,
+Void InteractivesDisplay::render_interactive ( SDL_Surface* back_buffer, const Interactive& interactive,
                                                SDL_Rect* dest_rect )
 {
      SDL_Rect clip_rect { 0, 0,
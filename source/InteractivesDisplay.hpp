@@ -24,10 +24,10 @@ namespace bryte
           Void render ( SDL_Surface* back_buffer, Interactives& interactives,
                         const Map& map, Real32 camera_x, Real32 camera_y, Bool invisible );
 
-          Void render_underneath ( SDL_Surface* back_buffer, UnderneathInteractive& underneath,
+          Void render_underneath ( SDL_Surface* back_buffer, const UnderneathInteractive& underneath,
                                    SDL_Rect* dest_rect );
 
-          Void render_interactive ( SDL_Surface* back_buffer, Interactive& interactive,
+          Void render_interactive ( SDL_Surface* back_buffer, const Interactive& interactive,
                                     SDL_Rect* dest_rect );
 
      public:
@@ -0,0 +1,75 @@
+#include "KernelSelect.hpp"
+#include "Utils.hpp"
+
+using namespace bryte;
+
+Bool bryte::cpu_supports ( CpuFeature feature )
+{
+     switch ( feature ) {
+     default:
+          return false;
+     case CpuFeature::cpu_baseline:
+          return true;
+#ifdef BRYTE_X86
+     case CpuFeature::cpu_sse2:
+          return true;
+     case CpuFeature::cpu_avx:
+          __builtin_cpu_init ( );
+          return __builtin_cpu_supports ( "avx" );
+     case CpuFeature::cpu_avx2:
+          __builtin_cpu_init ( );
+          return __builtin_cpu_supports ( "avx2" );
+#endif
+     }
+}
+
+KernelSelect::KernelSelect ( const Char8* kind, const Char8* const* names, const CpuFeature* features, Int32 count ) :
+     m_kind     ( kind ),
+     m_names    ( names ),
+     m_features ( features ),
+     m_count    ( count ),
+     m_selected ( count )
+{
+
+}
+
+Int32 KernelSelect::selected ( )
+{
+     if ( m_selected == m_count ) {
+          m_selected = 0;
+
+          for ( Int32 k = m_count - 1; k > 0; --k ) {
+               if ( supported ( k ) ) {
+                    m_selected = k;
+                    break;
+               }
+          }
+
+          LOG_INFO ( "Using %s %s kernel\n", m_names [ m_selected ], m_kind );
+     }
+
+     return m_selected;
+}
+
+Bool KernelSelect::supported ( Int32 kernel ) const
+{
+     return kernel >= 0 && kernel < m_count && cpu_supports ( m_features [ kernel ] );
+}
+
+Bool KernelSelect::select ( Int32 kernel )
+{
+     if ( !supported ( kernel ) ) {
+          LOG_WARNING ( "%s %s kernel isn't supported\n", name ( kernel ), m_kind );
+          return false;
+     }
+
+     m_selected = kernel;
+
+     return true;
+}
+
+const Char8* KernelSelect::name ( Int32 kernel ) const
+{
+     return kernel >= 0 && kernel < m_count ? m_names [ kernel ] : "unknown";
+}
+
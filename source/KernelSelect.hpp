@@ -0,0 +1,49 @@
+#ifndef BRYTE_KERNEL_SELECT_HPP
+#define BRYTE_KERNEL_SELECT_HPP
+
+#include "Types.hpp"
+
+#if defined ( __GNUC__ ) && defined ( __x86_64__ )
+     #define BRYTE_X86
+     #include <immintrin.h>
+#endif
+
+namespace bryte
+{
+     enum CpuFeature {
+          cpu_baseline,
+          cpu_sse2,
+          cpu_avx,
+          cpu_avx2,
+          cpu_feature_count
+     };
+
+     // sse2 is part of x86_64 so only the wider features are asked of the cpu
+     Bool cpu_supports ( CpuFeature feature );
+
+     // picks between kernels ordered narrowest first, the first must only need cpu_baseline
+     class KernelSelect {
+     public:
+
+          KernelSelect ( const Char8* kind, const Char8* const* names, const CpuFeature* features, Int32 count );
+
+          // the widest kernel the cpu supports, picked the first time it is asked for
+          Int32 selected ( );
+
+          Bool supported ( Int32 kernel ) const;
+          Bool select    ( Int32 kernel );
+
+          const Char8* name ( Int32 kernel ) const;
+
+     private:
+
+          const Char8*        m_kind;
+          const Char8* const* m_names;
+          const CpuFeature*   m_features;
+          Int32               m_count;
+          Int32               m_selected;
+     };
+}
+
+#endif
+
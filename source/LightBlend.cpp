@@ -0,0 +1,168 @@
+#include "LightBlend.hpp"
+
+#include "KernelSelect.hpp"
+
+using namespace bryte;
+
+typedef Void ( *LightKernelFunction ) ( Uint32* pixels, const Uint32* lights, Int32 start, Int32 count );
+
+// x * y / 255 rounded down without dividing, exact for every pair of bytes
+static inline Uint32 multiply_bytes ( Uint32 x, Uint32 y )
+{
+     Uint32 product = x * y;
+
+     return ( product + 1 + ( product >> 8 ) ) >> 8;
+}
+
+static Void blend_scalar ( Uint32* pixels, const Uint32* lights, Int32 start, Int32 count )
+{
+     for ( Int32 i = start; i < count; ++i ) {
+          Uint32 pixel = pixels [ i ];
+          Uint32 light = lights [ i ];
+          Uint32 blended = 0;
+
+          for ( Uint32 shift = 0; shift < 32; shift += 8 ) {
+               blended |= multiply_bytes ( ( pixel >> shift ) & 0xFF, ( light >> shift ) & 0xFF ) << shift;
+          }
+
+          pixels [ i ] = blended;
+     }
+}
+
+#ifdef BRYTE_X86
+
+static inline __m128i multiply_words_sse2 ( __m128i x, __m128i y )
+{
+     __m128i product = _mm_mullo_epi16 ( x, y );
+
+     return _mm_srli_epi16 ( _mm_add_epi16 ( _mm_add_epi16 ( product, _mm_set1_epi16 ( 1 ) ),
+                                             _mm_srli_epi16 ( product, 8 ) ), 8 );
+}
+
+// sse2 is part of x86_64 so this never needs checking for
+static Void blend_sse2 ( Uint32* pixels, const Uint32* lights, Int32 start, Int32 count )
+{
+     __m128i zero = _mm_setzero_si128 ( );
+     Int32 i = start;
+
+     for ( ; i + 4 <= count; i += 4 ) {
+          __m128i pixel = _mm_loadu_si128 ( reinterpret_cast<const __m128i*>( pixels + i ) );
+          __m128i light = _mm_loadu_si128 ( reinterpret_cast<const __m128i*>( lights + i ) );
+
+          __m128i low = multiply_words_sse2 ( _mm_unpacklo_epi8 ( pixel, zero ), _mm_unpacklo_epi8 ( light, zero ) );
+          __m128i high = multiply_words_sse2 ( _mm_unpackhi_epi8 ( pixel, zero ), _mm_unpackhi_epi8 ( light, zero ) );
+
+          _mm_storeu_si128 ( reinterpret_cast<__m128i*>( pixels + i ), _mm_packus_epi16 ( low, high ) );
+     }
+
+     blend_scalar ( pixels, lights, i, count );
+}
+
+__attribute__ (( target ( "avx2" ) ))
+static inline __m256i multiply_words_avx2 ( __m256i x, __m256i y )
+{
+     __m256i product = _mm256_mullo_epi16 ( x, y );
+
+     return _mm256_srli_epi16 ( _mm256_add_epi16 ( _mm256_add_epi16 ( product, _mm256_set1_epi16 ( 1 ) ),
+                                                   _mm256_srli_epi16 ( product, 8 ) ), 8 );
+}
+
+__attribute__ (( target ( "avx2" ) ))
+static Void blend_avx2 ( Uint32* pixels, const Uint32* lights, Int32 start, Int32 count )
+{
+     __m256i zero = _mm256_setzero_si256 ( );
+     Int32 i = start;
+
+     // unpacking and packing both work within 128 bit lanes, so the pixels come back in order
+     for ( ; i + 8 <= count; i += 8 ) {
+          __m256i pixel = _mm256_loadu_si256 ( reinterpret_cast<const __m256i*>( pixels + i ) );
+          __m256i light = _mm256_loadu_si256 ( reinterpret_cast<const __m256i*>( lights + i ) );
+
+          __m256i low = multiply_words_avx2 ( _mm256_unpacklo_epi8 ( pixel, zero ), _mm256_unpacklo_epi8 ( light, zero ) );
+          __m256i high = multiply_words_avx2 ( _mm256_unpackhi_epi8 ( pixel, zero ), _mm256_unpackhi_epi8 ( light, zero ) );
+
+          _mm256_storeu_si256 ( reinterpret_cast<__m256i*>( pixels + i ), _mm256_packus_epi16 ( low, high ) );
+     }
+
+     // the sse2 kernel isn't vex encoded, clear the upper halves first so mixing them isn't slow
+     _mm256_zeroupper ( );
+
+     blend_sse2 ( pixels, lights, i, count );
+}
+
+#endif
+
+static const LightKernelFunction c_kernel_functions [ LightKernel::light_kernel_count ] = {
+     blend_scalar,
+#ifdef BRYTE_X86
+     blend_sse2,
+     blend_avx2
+#else
+     nullptr,
+     nullptr
+#endif
+};
+
+static const Char8* c_kernel_names [ LightKernel::light_kernel_count ] = {
+     "scalar",
+     "sse2",
+     "avx2"
+};
+
+static const CpuFeature c_kernel_features [ LightKernel::light_kernel_count ] = {
+     CpuFeature::cpu_baseline,
+     CpuFeature::cpu_sse2,
+     CpuFeature::cpu_avx2
+};
+
+// statics are reset each time the game code is reloaded
+static KernelSelect g_kernels ( "light", c_kernel_names, c_kernel_features, LightKernel::light_kernel_count );
+
+Void bryte::blend_light_row ( Uint32* pixels, const Uint32* lights, Int32 count )
+{
+     c_kernel_functions [ g_kernels.selected ( ) ] ( pixels, lights, 0, count );
+}
+
+Void bryte::max_light_row ( Uint32* lights, const Uint32* sources, Int32 count )
+{
+     Int32 i = 0;
+
+#ifdef BRYTE_X86
+     for ( ; i + 4 <= count; i += 4 ) {
+          __m128i light = _mm_loadu_si128 ( reinterpret_cast<const __m128i*>( lights + i ) );
+          __m128i source = _mm_loadu_si128 ( reinterpret_cast<const __m128i*>( sources + i ) );
+
+          _mm_storeu_si128 ( reinterpret_cast<__m128i*>( lights + i ), _mm_max_epu8 ( light, source ) );
+     }
+#endif
+
+     for ( ; i < count; ++i ) {
+          Uint32 light = lights [ i ];
+          Uint32 source = sources [ i ];
+          Uint32 brighter = 0;
+
+          for ( Uint32 shift = 0; shift < 32; shift += 8 ) {
+               Uint32 a = ( light >> shift ) & 0xFF;
+               Uint32 b = ( source >> shift ) & 0xFF;
+
+               brighter |= ( a > b ? a : b ) << shift;
+          }
+
+          lights [ i ] = brighter;
+     }
+}
+
+Bool bryte::set_light_kernel ( LightKernel kernel )
+{
+     return g_kernels.select ( kernel );
+}
+
+LightKernel bryte::light_kernel ( )
+{
+     return static_cast<LightKernel>( g_kernels.selected ( ) );
+}
+
+const Char8* bryte::light_kernel_name ( LightKernel kernel )
+{
+     return g_kernels.name ( kernel );
+}
@@ -0,0 +1,30 @@
+#ifndef BRYTE_LIGHT_BLEND_HPP
+#define BRYTE_LIGHT_BLEND_HPP
+
+#include "Types.hpp"
+#include "Utils.hpp"
+
+namespace bryte
+{
+     enum LightKernel {
+          light_scalar,
+          light_sse2,
+          light_avx2,
+          light_kernel_count
+     };
+
+     // multiplies each byte of count pixels by the matching byte of lights as if both were 0 to 1,
+     // rounding down. A light byte of 255 leaves that channel untouched
+     Void blend_light_row ( Uint32* pixels, const Uint32* lights, Int32 count );
+
+     // keeps the brighter of each byte of count lights and sources. Rows of tiles are short enough
+     // that this always uses sse2 when it can rather than picking a kernel
+     Void max_light_row ( Uint32* lights, const Uint32* sources, Int32 count );
+
+     // the widest kernel the cpu supports is picked the first time a row is blended, this forces one
+     Bool set_light_kernel ( LightKernel kernel );
+     LightKernel light_kernel ( );
+     const Char8* light_kernel_name ( LightKernel kernel );
+}
+
+#endif
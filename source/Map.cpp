@@ -2,6 +2,7 @@
 #include "Utils.hpp"
 #include "Interactives.hpp"
 #include "Enemy.hpp"
+#include "LightBlend.hpp"
 
 #include <fstream>
 
@@ -125,6 +126,8 @@ Void Map::initialize ( Uint8 width, Uint8 height )
           }
      }
 
+     merge_walls ( );
+
      // clear border exits
      for ( Int32 i = 0; i < Direction::count; ++i ) {
           Auto& border_exit = m_border_exits [ i ];
@@ -140,6 +143,8 @@ Void Map::initialize ( Uint8 width, Uint8 height )
      m_upgrade.coordinates.x = 0;
      m_upgrade.coordinates.y = 0;
      m_upgrade.id = 0;
+
+     bump_tile_version ( );
 }
 
 Location Map::vector_to_location ( const Vector& v )
@@ -196,35 +201,72 @@ Bool Map::get_tile_location_invisible ( const Location& loc ) const
 }
 
 Uint8 Map::get_tile_location_light ( const Location& loc ) const
+{
+     return m_light [ location_to_tile_index ( loc ) ] >> 24;
+}
+
+Uint32 Map::get_tile_location_light_color ( const Location& loc ) const
 {
      return m_light [ location_to_tile_index ( loc ) ];
 }
 
 Void Map::set_tile_location_value ( const Location& loc, Uint8 value )
 {
-     m_tiles [ location_to_tile_index ( loc ) ].value = value;
+     Auto& tile = m_tiles [ location_to_tile_index ( loc ) ];
+
+     if ( tile.value == value ) {
+          return;
+     }
+
+     tile.value = value;
+     bump_tile_version ( );
+}
+
+// kept outside game memory so a snapshot restore can't roll it back, statics are reset each time the
+// game code is reloaded so it also starts past whatever the map already has
+static Uint32 g_last_tile_version = 0;
+
+Void Map::bump_tile_version ( )
+{
+     if ( m_tile_version > g_last_tile_version ) {
+          g_last_tile_version = m_tile_version;
+     }
+
+     m_tile_version = ++g_last_tile_version;
 }
 
 Void Map::set_tile_location_solid ( const Location& loc, Bool solid )
 {
      Auto& flags = m_tiles [ location_to_tile_index ( loc ) ].flags;
 
+     if ( static_cast<Bool>( flags & TileFlags::solid ) == solid ) {
+          return;
+     }
+
      if ( solid ) {
           flags |= TileFlags::solid;
      } else {
           flags &= ~TileFlags::solid;
      }
+
+     merge_walls ( );
 }
 
 Void Map::set_tile_location_invisible ( const Location& loc, Bool invisible )
 {
      Auto& flags = m_tiles [ location_to_tile_index ( loc ) ].flags;
 
+     if ( static_cast<Bool>( flags & TileFlags::invisible ) == invisible ) {
+          return;
+     }
+
      if ( invisible ) {
           flags |= TileFlags::invisible;
      } else {
           flags &= ~TileFlags::invisible;
      }
+
+     bump_tile_version ( );
 }
 
 Map::Fixture* Map::check_location_for_decor ( const Location& loc )
@@ -250,84 +292,335 @@ Uint8 Map::base_light_value ( ) const
 Void Map::set_base_light ( Uint8 base )
 {
      m_base_light_value = base;
+     m_lamp_light_stale = true;
 }
 
 Void Map::add_to_base_light ( Uint8 delta )
 {
      m_base_light_value += delta;
+     m_lamp_light_stale = true;
 }
 
 Void Map::subtract_from_base_light ( Uint8 delta )
 {
      m_base_light_value -= delta;
+     m_lamp_light_stale = true;
 }
 
-Void Map::illuminate ( const Location& loc, Uint8 value )
+Bool Map::light_bounds ( const Location& loc, Uint8 value,
+                         Int32* min_x, Int32* min_y, Int32* max_x, Int32* max_y ) const
 {
      Int32 radius = ( ( value - m_base_light_value ) / c_light_decay );
 
      if ( radius < 0 ) {
-          return;
+          return false;
      }
 
      radius++;
 
-     Int32 min_x  = loc.x - radius;
-     Int32 max_x  = loc.x + radius;
-     Int32 min_y  = loc.y - radius;
-     Int32 max_y  = loc.y + radius;
+     *min_x = loc.x - radius;
+     *max_x = loc.x + radius;
+     *min_y = loc.y - radius;
+     *max_y = loc.y + radius;
 
-     CLAMP ( min_x, 0, m_width - 1 );
-     CLAMP ( max_x, 0, m_width - 1 );
-     CLAMP ( min_y, 0, m_height - 1 );
-     CLAMP ( max_y, 0, m_height - 1 );
+     CLAMP ( *min_x, 0, m_width - 1 );
+     CLAMP ( *max_x, 0, m_width - 1 );
+     CLAMP ( *min_y, 0, m_height - 1 );
+     CLAMP ( *max_y, 0, m_height - 1 );
 
-     for ( Int32 j = min_y; j <= max_y; ++j ) {
-          for ( Int32 i = min_x; i <= max_x; ++i ) {
-#if 1
-               Real32 diff_x = static_cast<Real32>( loc.x - i );
-               Real32 diff_y = static_cast<Real32>( loc.y - j );
-               Int32 distance = static_cast<Int32>( sqrt ( diff_x * diff_x + diff_y * diff_y ) ) - 1;
-#else
-               Int32 diff_x = loc.x - i;
-               Int32 diff_y = loc.y - j;
-               Int32 distance = abs ( diff_x ) + abs ( diff_y ) - 1;
-#endif
+     return true;
+}
+
+// each byte of color scales the same byte of the light, x * y / 255 rounded down
+static Uint32 tint_light ( Uint8 value, Uint32 color )
+{
+     Uint32 tinted = 0;
+
+     for ( Uint32 shift = 0; shift < 32; shift += 8 ) {
+          Uint32 product = value * ( ( color >> shift ) & 0xFF );
+
+          tinted |= ( ( product + 1 + ( product >> 8 ) ) >> 8 ) << shift;
+     }
+
+     return tinted;
+}
+
+const Map::LightStamp& Map::light_stamp ( Uint8 value, Uint32 color ) const
+{
+     for ( Int32 i = 0; i < m_light_stamp_count; ++i ) {
+          Auto& stamp = m_light_stamps [ i ];
+
+          if ( stamp.value == value && stamp.color == color && stamp.base == m_base_light_value ) {
+               return stamp;
+          }
+     }
+
+     // reuse the oldest once every slot is taken, maps rarely have more than a few kinds of source
+     Int32 slot = m_light_stamp_count;
+
+     if ( slot < c_max_light_stamps ) {
+          m_light_stamp_count++;
+     } else {
+          slot = m_next_light_stamp;
+          m_next_light_stamp = ( m_next_light_stamp + 1 ) % c_max_light_stamps;
+     }
+
+     Auto& stamp = m_light_stamps [ slot ];
+
+     stamp.value = value;
+     stamp.base = m_base_light_value;
+     stamp.color = color;
+     stamp.radius = ( ( value - m_base_light_value ) / c_light_decay ) + 1;
+
+     for ( Int32 y = -c_max_light_radius; y <= c_max_light_radius; ++y ) {
+          for ( Int32 x = -c_max_light_radius; x <= c_max_light_radius; ++x ) {
+               // whole tiles away from the center, the integer square root is what truncating sqrt ( ) gave
+               Int32 squared = x * x + y * y;
+               Int32 root = 0;
+
+               while ( ( root + 1 ) * ( root + 1 ) <= squared ) {
+                    root++;
+               }
+
+               Int32 distance = root - 1;
 
                if ( distance < 0 ) {
                     distance = 0;
                }
 
-               if ( distance > radius ) {
-                    continue;
+               // nothing is dimmer than 0 so blending it changes nothing, the same as skipping the tile
+               Uint8 light = 0;
+
+               if ( distance <= stamp.radius ) {
+                    light = value - ( distance * c_light_decay );
                }
 
-               Uint8& light_value     = m_light [ j * m_width + i ];
-               Uint8  new_light_value = value - ( distance * c_light_decay );
+               stamp.light [ ( y + c_max_light_radius ) * c_light_stamp_width + x + c_max_light_radius ] =
+                    tint_light ( light, color );
+          }
+     }
 
-               if ( light_value < new_light_value ) {
-                    light_value = new_light_value;
-               }
+     return stamp;
+}
+
+Void Map::illuminate ( Uint32* light, const Location& loc, Uint8 value, Uint32 color ) const
+{
+     Int32 min_x, min_y, max_x, max_y;
+
+     if ( !light_bounds ( loc, value, &min_x, &min_y, &max_x, &max_y ) ) {
+          return;
+     }
+
+     const Auto& stamp = light_stamp ( value, color );
+
+     // a source off the map is clamped onto its edge, only the part of the stamp that reaches is used
+     if ( min_x < loc.x - stamp.radius ) {
+          min_x = loc.x - stamp.radius;
+     }
+
+     if ( max_x > loc.x + stamp.radius ) {
+          max_x = loc.x + stamp.radius;
+     }
+
+     if ( min_y < loc.y - stamp.radius ) {
+          min_y = loc.y - stamp.radius;
+     }
+
+     if ( max_y > loc.y + stamp.radius ) {
+          max_y = loc.y + stamp.radius;
+     }
+
+     for ( Int32 j = min_y; j <= max_y; ++j ) {
+          const Uint32* stamp_row = stamp.light + ( j - loc.y + c_max_light_radius ) * c_light_stamp_width +
+                                    c_max_light_radius - loc.x;
+          Uint32* light_row = light + j * m_width;
+
+          max_light_row ( light_row + min_x, stamp_row + min_x, max_x - min_x + 1 );
+     }
+}
+
+Bool Map::mark_light ( Uint64* mask, Int32* bounds, const Location& loc, Uint8 value ) const
+{
+     Int32 min_x, min_y, max_x, max_y;
+
+     if ( !light_bounds ( loc, value, &min_x, &min_y, &max_x, &max_y ) ) {
+          return false;
+     }
+
+     bounds [ 0 ] = min_x < bounds [ 0 ] ? min_x : bounds [ 0 ];
+     bounds [ 1 ] = min_y < bounds [ 1 ] ? min_y : bounds [ 1 ];
+     bounds [ 2 ] = max_x > bounds [ 2 ] ? max_x : bounds [ 2 ];
+     bounds [ 3 ] = max_y > bounds [ 3 ] ? max_y : bounds [ 3 ];
+
+     for ( Int32 j = min_y; j <= max_y; ++j ) {
+          for ( Int32 i = min_x; i <= max_x; ++i ) {
+               Int32 index = j * m_width + i;
+
+               mask [ index / 64 ] |= 1ull << ( index % 64 );
           }
      }
+
+     return true;
 }
 
-Void Map::reset_light ( )
+static Bool light_source_listed ( const Map::LightSource& source, const Map::LightSource* sources, Int32 count )
+{
+     for ( Int32 i = 0; i < count; ++i ) {
+          if ( sources [ i ].location == source.location && sources [ i ].value == source.value &&
+               sources [ i ].color == source.color ) {
+               return true;
+          }
+     }
+
+     return false;
+}
+
+Void Map::relight_all ( )
 {
      Int32 tile_count = m_width * m_height;
 
      for ( Int32 i = 0; i < tile_count; ++i ) {
-          m_light [ i ] = m_base_light_value;
+          m_light [ i ] = m_lamp_light [ i ];
      }
 
-     for ( Uint8 i = 0; i < m_lamp_count; ++i ) {
-          Auto& lamp = m_lamps [ i ];
-          Location center ( lamp.coordinates );
+     m_relighting_all = true;
+}
 
-          illuminate ( center, c_lamp_light );
+Void Map::reset_light ( )
+{
+     m_lamp_light_stale = true;
+
+     begin_light ( );
+     end_light ( );
+}
+
+Void Map::begin_light ( )
+{
+     // blending takes the brightest value, so the order sources are added in doesn't matter and the
+     // lamps can be blended once up front
+     if ( m_lamp_light_stale ) {
+          Int32 tile_count = m_width * m_height;
+
+          // the base light is white
+          for ( Int32 i = 0; i < tile_count; ++i ) {
+               m_lamp_light [ i ] = m_base_light_value * 0x01010101u;
+          }
+
+          for ( Uint8 i = 0; i < m_lamp_count; ++i ) {
+               Auto& lamp = m_lamps [ i ];
+               Location center ( lamp.coordinates );
+
+               illuminate ( m_lamp_light, center, c_lamp_light, m_lamp_colors [ i ] | 0xFF000000 );
+          }
+
+          m_lamp_light_stale = false;
+          m_light_source_count = -1;
+     }
+
+     m_pending_light_source_count = 0;
+     m_relighting_all = false;
+
+     if ( m_light_source_count < 0 ) {
+          relight_all ( );
      }
 }
 
+Void Map::add_light ( const Location& loc, Uint8 value, Uint32 color )
+{
+     if ( m_relighting_all ) {
+          illuminate ( m_light, loc, value, color );
+     }
+
+     if ( m_pending_light_source_count < 0 ) {
+          return;
+     }
+
+     if ( m_pending_light_source_count >= c_max_light_sources ) {
+          // too many to diff, relight everything from what has been added so far
+          if ( !m_relighting_all ) {
+               relight_all ( );
+
+               for ( Int32 i = 0; i < m_pending_light_source_count; ++i ) {
+                    illuminate ( m_light, m_pending_light_sources [ i ].location,
+                                 m_pending_light_sources [ i ].value, m_pending_light_sources [ i ].color );
+               }
+
+               illuminate ( m_light, loc, value, color );
+          }
+
+          m_pending_light_source_count = -1;
+          return;
+     }
+
+     Auto& source = m_pending_light_sources [ m_pending_light_source_count++ ];
+
+     source.location = loc;
+     source.value = value;
+     source.color = color;
+}
+
+Void Map::end_light ( )
+{
+     if ( !m_relighting_all ) {
+          // the tiles reached by any source that isn't exactly the same as last frame
+          Uint64 mask [ c_light_mask_words ] = { };
+          Int32 bounds [ 4 ] = { m_width, m_height, -1, -1 };
+          Bool changed = false;
+
+          for ( Int32 i = 0; i < m_light_source_count; ++i ) {
+               if ( !light_source_listed ( m_light_sources [ i ], m_pending_light_sources,
+                                           m_pending_light_source_count ) ) {
+                    changed |= mark_light ( mask, bounds, m_light_sources [ i ].location, m_light_sources [ i ].value );
+               }
+          }
+
+          for ( Int32 i = 0; i < m_pending_light_source_count; ++i ) {
+               if ( !light_source_listed ( m_pending_light_sources [ i ], m_light_sources,
+                                           m_light_source_count ) ) {
+                    changed |= mark_light ( mask, bounds, m_pending_light_sources [ i ].location,
+                                            m_pending_light_sources [ i ].value );
+               }
+          }
+
+          if ( changed ) {
+               for ( Int32 w = 0; w < c_light_mask_words; ++w ) {
+                    if ( !mask [ w ] ) {
+                         continue;
+                    }
+
+                    for ( Int32 b = 0; b < 64; ++b ) {
+                         if ( mask [ w ] & ( 1ull << b ) ) {
+                              m_light [ w * 64 + b ] = m_lamp_light [ w * 64 + b ];
+                         }
+                    }
+               }
+
+               // only sources reaching the relit tiles need blending again. The tiles around them
+               // that weren't reset already hold their light, blending it twice changes nothing
+               for ( Int32 i = 0; i < m_pending_light_source_count; ++i ) {
+                    Auto& source = m_pending_light_sources [ i ];
+                    Int32 min_x, min_y, max_x, max_y;
+
+                    if ( !light_bounds ( source.location, source.value, &min_x, &min_y, &max_x, &max_y ) ||
+                         max_x < bounds [ 0 ] || max_y < bounds [ 1 ] ||
+                         min_x > bounds [ 2 ] || min_y > bounds [ 3 ] ) {
+                         continue;
+                    }
+
+                    illuminate ( m_light, source.location, source.value, source.color );
+               }
+          }
+     }
+
+     m_light_source_count = m_pending_light_source_count;
+
+     for ( Int32 i = 0; i < m_light_source_count; ++i ) {
+          m_light_sources [ i ] = m_pending_light_sources [ i ];
+     }
+
+     m_relighting_all = false;
+}
+
 Bool Map::add_decor ( const Location& loc, Uint8 id )
 {
      if ( !add_element<Fixture> ( m_decors, &m_decor_count, c_max_decors ) ) {
@@ -335,6 +628,7 @@ Bool Map::add_decor ( const Location& loc, Uint8 id )
      }
 
      m_decors [ m_decor_count - 1 ].set ( loc.x, loc.y, id );
+     bump_tile_version ( );
 
      return true;
 }
@@ -342,6 +636,7 @@ Bool Map::add_decor ( const Location& loc, Uint8 id )
 Void Map::remove_decor ( Fixture* decor )
 {
      remove_element<Fixture> ( m_decors, &m_decor_count, c_max_decors, decor );
+     bump_tile_version ( );
 }
 
 Bool Map::add_lamp ( const Location& loc, Uint8 id )
@@ -351,13 +646,36 @@ Bool Map::add_lamp ( const Location& loc, Uint8 id )
      }
 
      m_lamps [ m_lamp_count - 1 ].set ( loc.x, loc.y, id );
+     m_lamp_colors [ m_lamp_count - 1 ] = ( id < c_unique_lamp_count ) ? m_lamp_palette [ id ] : c_white_lamp;
+     m_lamp_light_stale = true;
 
      return true;
 }
 
 Void Map::remove_lamp ( Fixture* lamp )
 {
+     // colors live alongside the lamps so the map format didn't change, slide them down the same way
+     for ( Int32 i = static_cast<Int32>( lamp - m_lamps ); i < m_lamp_count - 1; ++i ) {
+          m_lamp_colors [ i ] = m_lamp_colors [ i + 1 ];
+     }
+
      remove_element<Fixture> ( m_lamps, &m_lamp_count, c_max_lamps, lamp );
+     m_lamp_light_stale = true;
+}
+
+Void Map::set_lamp_color ( Uint8 index, Uint32 color )
+{
+     ASSERT ( index < m_lamp_count );
+
+     m_lamp_colors [ index ] = color & c_white_lamp;
+     m_lamp_light_stale = true;
+}
+
+Void Map::set_lamp_palette ( const Uint32* colors )
+{
+     for ( Uint8 i = 0; i < c_unique_lamp_count; ++i ) {
+          m_lamp_palette [ i ] = colors ? ( colors [ i ] & c_white_lamp ) : c_white_lamp;
+     }
 }
 
 Bool Map::add_enemy_spawn ( const Location& loc, Uint8 id,
@@ -487,6 +805,12 @@ Void Map::save ( const Char8* filepath, Interactives& interactives )
      file.write ( reinterpret_cast<const Char8*> ( &m_secret.clear_tile ), sizeof ( m_secret.clear_tile ) );
 
      file.write ( reinterpret_cast<const Char8*> ( &m_upgrade ), sizeof ( m_upgrade ) );
+
+     file.write ( reinterpret_cast<const Char8*>( &m_lamp_count ), sizeof ( m_lamp_count ) );
+
+     for ( Int32 i = 0; i < m_lamp_count; ++i ) {
+          file.write ( reinterpret_cast<const Char8*>( &m_lamp_colors [ i ] ), sizeof ( m_lamp_colors [ i ] ) );
+     }
 }
 
 Bool Map::load ( const Char8* filepath, Interactives& interactives )
@@ -518,6 +842,10 @@ Bool Map::load ( const Char8* filepath, Interactives& interactives )
           }
      }
 
+     merge_walls ( );
+
+     bump_tile_version ( );
+
      file.read ( reinterpret_cast<Char8*>( &m_decor_count ), sizeof ( m_decor_count ) );
 
      for ( Int32 i = 0; i < m_decor_count; ++i ) {
@@ -534,8 +862,6 @@ Bool Map::load ( const Char8* filepath, Interactives& interactives )
 
      file.read ( reinterpret_cast<Char8*> ( &m_base_light_value ), sizeof ( m_base_light_value ) );
 
-     reset_light ( );
-
      file.read ( reinterpret_cast<Char8*>( &m_enemy_spawn_count ), sizeof ( m_enemy_spawn_count ) );
 
      for ( Int32 i = 0; i < m_enemy_spawn_count; ++i ) {
@@ -564,6 +890,31 @@ Bool Map::load ( const Char8* filepath, Interactives& interactives )
 
      file.read ( reinterpret_cast<Char8*> ( &m_upgrade ), sizeof ( m_upgrade ) );
 
+     // lamp colors come after everything else, maps saved before they existed end here and their
+     // lamps take the palette's colors
+     Uint8 lamp_color_count = 0;
+
+     file.read ( reinterpret_cast<Char8*> ( &lamp_color_count ), sizeof ( lamp_color_count ) );
+
+     if ( !file ) {
+          lamp_color_count = 0;
+     }
+
+     for ( Int32 i = 0; i < m_lamp_count; ++i ) {
+          Uint32 color = 0;
+
+          if ( i < lamp_color_count &&
+               file.read ( reinterpret_cast<Char8*> ( &color ), sizeof ( color ) ) ) {
+               m_lamp_colors [ i ] = color & c_white_lamp;
+          } else {
+               Uint8 id = m_lamps [ i ].id;
+
+               m_lamp_colors [ i ] = ( id < c_unique_lamp_count ) ? m_lamp_palette [ id ] : c_white_lamp;
+          }
+     }
+
+     reset_light ( );
+
      return true;
 }
 
@@ -785,6 +1136,73 @@ Void Map::restore_activate_on_kill_all ( Interactives& interactives )
      }
 }
 
+Void Map::merge_walls ( )
+{
+     Int16 width = m_width;
+     Int16 height = m_height;
+
+     // characters treat the tiles just outside the map as solid
+     m_walls [ 0 ] = Wall { -1, -1, width, -1 };
+     m_walls [ 1 ] = Wall { -1, height, width, height };
+     m_walls [ 2 ] = Wall { -1, 0, -1, static_cast<Int16>( height - 1 ) };
+     m_walls [ 3 ] = Wall { width, 0, width, static_cast<Int16>( height - 1 ) };
+     m_wall_count = 4;
+
+     Bool merged [ c_max_tiles ] = { };
+
+     // greedily take the longest run along a row, then grow it up while every tile above is free
+     for ( Int32 y = 0; y < height; ++y ) {
+          for ( Int32 x = 0; x < width; ++x ) {
+               Int32 index = y * width + x;
+
+               if ( !( m_tiles [ index ].flags & TileFlags::solid ) || merged [ index ] ) {
+                    continue;
+               }
+
+               Int32 right = x;
+
+               while ( right + 1 < width &&
+                       ( m_tiles [ index + 1 ].flags & TileFlags::solid ) && !merged [ index + 1 ] ) {
+                    right++;
+                    index++;
+               }
+
+               Int32 top = y;
+
+               while ( top + 1 < height ) {
+                    Int32 row = ( top + 1 ) * width;
+                    Bool free = true;
+
+                    for ( Int32 rx = x; rx <= right; ++rx ) {
+                         if ( !( m_tiles [ row + rx ].flags & TileFlags::solid ) || merged [ row + rx ] ) {
+                              free = false;
+                              break;
+                         }
+                    }
+
+                    if ( !free ) {
+                         break;
+                    }
+
+                    top++;
+               }
+
+               for ( Int32 my = y; my <= top; ++my ) {
+                    for ( Int32 mx = x; mx <= right; ++mx ) {
+                         merged [ my * width + mx ] = true;
+                         m_tile_walls [ my * width + mx ] = m_wall_count;
+                    }
+               }
+
+               ASSERT ( m_wall_count < c_max_walls );
+
+               m_walls [ m_wall_count ] = Wall { static_cast<Int16>( x ), static_cast<Int16>( y ),
+                                                 static_cast<Int16>( right ), static_cast<Int16>( top ) };
+               m_wall_count++;
+          }
+     }
+}
+
 Void Map::find_secret ( )
 {
      if ( m_secret.found ) {
@@ -41,8 +41,25 @@ namespace bryte
           static const Uint8  c_unique_lamp_count = 5;
           static const Uint8  c_lamp_light = 224;
 
+          // light is packed 0xIIRRGGBB, II is the brightness gameplay sees and the rest is what is drawn.
+          // Sources tint each channel by their color, one with no II doesn't count as light
+          static const Uint32 c_white_light = 0xFFFFFFFF;
+          static const Uint32 c_fire_light  = 0xFFFFB070;
+          static const Uint32 c_ice_light   = 0x0070A0FF;
+
+          // lamp colors are rgb, they always count as light
+          static const Uint32 c_white_lamp  = 0xFFFFFF;
+
           static const Uint32 c_max_enemy_spawns = 32;
 
+          static const Int32  c_max_light_sources = 64;
+          static const Int32  c_max_light_radius = 255 / c_light_decay + 1;
+          static const Int32  c_light_stamp_width = c_max_light_radius * 2 + 1;
+          static const Int32  c_max_light_stamps = 16;
+          static const Int32  c_light_mask_words = c_max_tiles / 64;
+
+          static const Uint32 c_max_walls = c_max_tiles + Direction::count;
+
      public:
 
           enum TileFlags {
@@ -99,6 +116,30 @@ namespace bryte
                Coordinates map_bottom_left;
           };
 
+          // anything other than a lamp that gives off light
+          struct LightSource {
+               Location location;
+               Uint8    value;
+               Uint32   color;
+          };
+
+          // the light a source gives every tile around it, centered in the square
+          struct LightStamp {
+               Uint8  value;
+               Uint8  base;
+               Uint32 color;
+               Int32  radius;
+               Uint32 light [ c_light_stamp_width * c_light_stamp_width ];
+          };
+
+          // a rect of solid tiles, the corners are inclusive tile locations
+          struct Wall {
+               Int16 left;
+               Int16 bottom;
+               Int16 right;
+               Int16 top;
+          };
+
      public:
 
           Map ( );
@@ -121,6 +162,7 @@ namespace bryte
           Bool  get_tile_location_solid ( const Location& loc ) const;
           Bool  get_tile_location_invisible ( const Location& loc ) const;
           Uint8 get_tile_location_light ( const Location& loc ) const;
+          Uint32 get_tile_location_light_color ( const Location& loc ) const;
 
           Void  set_tile_location_value ( const Location& loc, Uint8 value );
           Void  set_tile_location_solid ( const Location& loc, Bool solid );
@@ -135,9 +177,16 @@ namespace bryte
           Void  add_to_base_light        ( Uint8 delta );
           Void  subtract_from_base_light ( Uint8 delta );
 
-          Void illuminate  ( const Location& loc, Uint8 value );
+          // lights the map from the lamps and base light, forgetting any other sources
           Void reset_light ( );
 
+          // lamps and the base light are cached, other sources are added between begin_light ( ) and
+          // end_light ( ) every frame. Only tiles lit by a source that appeared, changed or went out since
+          // the last frame are recalculated
+          Void begin_light ( );
+          Void add_light   ( const Location& loc, Uint8 value, Uint32 color = c_white_light );
+          Void end_light   ( );
+
           Bool add_decor       ( const Location& loc, Uint8 id );
           Bool add_lamp        ( const Location& loc, Uint8 id );
           Bool add_enemy_spawn ( const Location& loc, Uint8 id,
@@ -145,6 +194,11 @@ namespace bryte
 
           Void remove_decor       ( Fixture* decor );
           Void remove_lamp        ( Fixture* lamp );
+
+          Void set_lamp_color ( Uint8 index, Uint32 color );
+
+          // colors new lamps and lamps in maps saved without colors get by id, nullptr makes them all white
+          Void set_lamp_palette ( const Uint32* colors );
           Void remove_enemy_spawn ( EnemySpawn* enemy_spawn );
 
           Void set_border_exit ( Direction side, const BorderExit& border_exit );
@@ -171,10 +225,21 @@ namespace bryte
 
           inline Fixture&    decor       ( Uint8 index );
           inline Fixture&    lamp        ( Uint8 index );
+          inline Uint32      lamp_color  ( Uint8 index ) const;
           inline EnemySpawn& enemy_spawn ( Uint8 index );
 
+          inline Uint32      wall_count  ( ) const;
+          inline const Wall& wall        ( Uint32 index ) const;
+
+          // index of the wall a solid tile, or a tile just outside the map, was merged into
+          inline Uint32      wall_covering ( const Location& loc ) const;
+
           inline Bool tile_location_is_valid ( const Location& loc ) const;
 
+          // changes whenever a tile is drawn differently or decor comes or goes, never to a
+          // version this run has handed out before, even if the map is rewound
+          inline Uint32 tile_version ( ) const;
+
           inline Int32 current_master_map ( ) const;
           inline Void set_activate_location_on_all_enemies_killed ( Coordinates loc );
           inline Coordinates activate_on_all_enemies_killed ( ) const;
@@ -212,6 +277,24 @@ namespace bryte
           Void restore_enemy_spawns ( );
           Void restore_activate_on_kill_all ( Interactives& interactives );
 
+          Void merge_walls ( );
+
+          Void bump_tile_version ( );
+
+          // the tiles a source reaches, false if it is too dim to light any
+          Bool light_bounds ( const Location& loc, Uint8 value,
+                              Int32* min_x, Int32* min_y, Int32* max_x, Int32* max_y ) const;
+
+          // built the first time a value and color is lit against the current base light
+          const LightStamp& light_stamp ( Uint8 value, Uint32 color ) const;
+
+          // max blends a source into light, each channel on its own
+          Void illuminate ( Uint32* light, const Location& loc, Uint8 value, Uint32 color ) const;
+          // sets the tiles a source reaches in mask and grows bounds, min x, min y, max x, max y, to cover them
+          Bool mark_light ( Uint64* mask, Int32* bounds, const Location& loc, Uint8 value ) const;
+
+          Void relight_all ( );
+
      private:
 
           Char8          m_master_list [ c_max_maps ][ c_max_map_name_size ];
@@ -222,18 +305,44 @@ namespace bryte
 
           Tile           m_tiles [ c_max_tiles ];
 
+          // solid tiles merged into as few rects as possible, plus the ring around the map
+          Wall           m_walls [ c_max_walls ];
+          Uint32         m_wall_count;
+          Uint16         m_tile_walls [ c_max_tiles ];
+
           Uint8          m_width;
           Uint8          m_height;
 
+          Uint32         m_tile_version;
+
           Uint8          m_base_light_value;
-          Uint8          m_light [ c_max_tiles ];
+          Uint32         m_light [ c_max_tiles ];
+
+          // the base light with the lamps blended in
+          Uint32         m_lamp_light [ c_max_tiles ];
+          Bool           m_lamp_light_stale;
+
+          // sources m_light was built from last frame and the ones added this frame, -1 when
+          // there were too many to remember so the next frame has to relight everything
+          LightSource    m_light_sources [ c_max_light_sources ];
+          Int32          m_light_source_count;
+          LightSource    m_pending_light_sources [ c_max_light_sources ];
+          Int32          m_pending_light_source_count;
+          Bool           m_relighting_all;
+
+          mutable LightStamp m_light_stamps [ c_max_light_stamps ];
+          mutable Int32      m_light_stamp_count;
+          mutable Int32      m_next_light_stamp;
 
           Fixture        m_decors [ c_max_decors ];
           Uint8          m_decor_count;
 
           Fixture        m_lamps [ c_max_lamps ];
+          Uint32         m_lamp_colors [ c_max_lamps ];
           Uint8          m_lamp_count;
 
+          Uint32         m_lamp_palette [ c_unique_lamp_count ];
+
           EnemySpawn     m_enemy_spawns [ c_max_enemy_spawns ];
           Uint8          m_enemy_spawn_count;
 
@@ -278,6 +387,13 @@ namespace bryte
           return m_lamps [ index ];
      }
 
+     inline Uint32 Map::lamp_color ( Uint8 index ) const
+     {
+          ASSERT ( index < m_lamp_count );
+
+          return m_lamp_colors [ index ];
+     }
+
      inline Map::Fixture& Map::decor ( Uint8 index )
      {
           ASSERT ( index < m_decor_count );
@@ -302,6 +418,36 @@ namespace bryte
           return m_enemy_spawns [ index ];
      }
 
+     inline Uint32 Map::wall_count ( ) const
+     {
+          return m_wall_count;
+     }
+
+     inline const Map::Wall& Map::wall ( Uint32 index ) const
+     {
+          ASSERT ( index < m_wall_count );
+
+          return m_walls [ index ];
+     }
+
+     inline Uint32 Map::wall_covering ( const Location& loc ) const
+     {
+          // the ring around the map is always the first 4 walls
+          if ( loc.y < 0 ) {
+               return 0;
+          } else if ( loc.y >= height ( ) ) {
+               return 1;
+          } else if ( loc.x < 0 ) {
+               return 2;
+          } else if ( loc.x >= width ( ) ) {
+               return 3;
+          }
+
+          ASSERT ( get_tile_location_solid ( loc ) );
+
+          return m_tile_walls [ loc.y * width ( ) + loc.x ];
+     }
+
      template < typename T >
      Bool Map::add_element ( T* element_array, Uint8* element_count, Uint8 max_elements )
      {
@@ -351,6 +497,11 @@ namespace bryte
                  loc.y >= 0 && loc.y < height ( );
      }
 
+     inline Uint32 Map::tile_version ( ) const
+     {
+          return m_tile_version;
+     }
+
      inline Int32 Map::current_master_map ( ) const
      {
           return m_current_map;
@@ -2,9 +2,32 @@
 #include "Utils.hpp"
 #include "GameMemory.hpp"
 #include "Bitmap.hpp"
+#include "Profiler.hpp"
+#include "LightBlend.hpp"
 
 using namespace bryte;
 
+// tiles and decor that don't animate, drawn once in the back buffer's format. It lives outside game
+// memory, a snapshot restore would otherwise bring back a surface freed since along with a version
+// that still matches the map. Statics are reset each time the game code is reloaded, which frees it
+struct MapLayer {
+     ~MapLayer ( )
+     {
+          FREE_SURFACE ( surface );
+     }
+
+     SDL_Surface* surface;
+     Uint32 version;
+     Bool invisibles;
+     Bool stale;
+
+     // size that couldn't be created, so it is only logged once
+     Int32 failed_width;
+     Int32 failed_height;
+};
+
+static MapLayer g_map_layer;
+
 Void MapDisplay::clear ( )
 {
      tilesheet = nullptr;
@@ -17,6 +40,9 @@ Void MapDisplay::clear ( )
 Bool MapDisplay::load_surfaces ( GameMemory& game_memory, const Char8* tilesheet_filepath,
                                  const Char8* decorsheet_filepath, const Char8* lampsheet_filepath )
 {
+     // the layer is redrawn from the new sheets on the next render
+     g_map_layer.stale = true;
+
      if ( !load_bitmap_with_game_memory ( tilesheet, game_memory, tilesheet_filepath ) ) {
           return false;
      }
@@ -37,6 +63,7 @@ Void MapDisplay::unload_surfaces ( )
      FREE_SURFACE ( tilesheet );
      FREE_SURFACE ( decorsheet );
      FREE_SURFACE ( lampsheet );
+     FREE_SURFACE ( g_map_layer.surface );
 }
 
 Void MapDisplay::tick ( )
@@ -47,7 +74,6 @@ Void MapDisplay::tick ( )
 static Void render_map_with_invisibles ( SDL_Surface* back_buffer, SDL_Surface* tilesheet, Map& map,
                                          Real32 camera_x, Real32 camera_y )
 {
-     // TODO: optimize to only draw to the part of the back buffer we can see
      for ( Location tile; tile.y < static_cast<Int32>( map.height ( ) ); ++tile.y ) {
           for ( tile.x = 0; tile.x < static_cast<Int32>( map.width ( ) ); ++tile.x ) {
                Auto tile_value = map.get_tile_location_value ( tile );
@@ -78,7 +104,6 @@ static Void render_map_with_invisibles ( SDL_Surface* back_buffer, SDL_Surface*
 static Void render_map ( SDL_Surface* back_buffer, SDL_Surface* tilesheet, Map& map,
                          Real32 camera_x, Real32 camera_y )
 {
-     // TODO: optimize to only draw to the part of the back buffer we can see
      for ( Location tile; tile.y < static_cast<Int32>( map.height ( ) ); ++tile.y ) {
           for ( tile.x = 0; tile.x < static_cast<Int32>( map.width ( ) ); ++tile.x ) {
                Auto tile_value = map.get_tile_location_value ( tile );
@@ -214,89 +239,306 @@ static Void render_map_lamps ( SDL_Surface* back_buffer, SDL_Surface* lamp_sheet
      }
 }
 
+// draws the tiles and decor of the whole map into the layer if they changed since it was drawn
+static Bool bake_map_layer ( SDL_Surface* back_buffer, SDL_Surface* tilesheet, SDL_Surface* decorsheet,
+                             Map& map, Bool invisibles )
+{
+     MapLayer& layer = g_map_layer;
+
+     if ( layer.surface && !layer.stale &&
+          layer.version == map.tile_version ( ) && layer.invisibles == invisibles ) {
+          return true;
+     }
+
+     PROFILE_ZONE ( "MapDisplay::bake_map_layer" );
+
+     Int32 width = map.width ( ) * Map::c_tile_dimension_in_pixels;
+     Int32 height = map.height ( ) * Map::c_tile_dimension_in_pixels;
+
+     if ( layer.surface && ( layer.surface->w != width || layer.surface->h != height ) ) {
+          FREE_SURFACE ( layer.surface );
+     }
+
+     if ( !layer.surface ) {
+          // the map is drawn a tile at a time until it changes size
+          if ( layer.failed_width == width && layer.failed_height == height ) {
+               return false;
+          }
+
+          const SDL_PixelFormat* format = back_buffer->format;
+
+          layer.surface = SDL_CreateRGBSurface ( 0, width, height, 32,
+                                                 format->Rmask, format->Gmask, format->Bmask, 0 );
+
+          if ( !layer.surface ) {
+               LOG_ERROR ( "SDL_CreateRGBSurface() failed: %s\n", SDL_GetError ( ) );
+          } else if ( SDL_SetColorKey ( layer.surface, SDL_TRUE,
+                                        SDL_MapRGB ( layer.surface->format, 255, 0, 255 ) ) ) {
+               LOG_ERROR ( "SDL_SetColorKey() failed: %s\n", SDL_GetError ( ) );
+               FREE_SURFACE ( layer.surface );
+          }
+
+          if ( !layer.surface ) {
+               layer.failed_width = width;
+               layer.failed_height = height;
+               return false;
+          }
+     }
+
+     // empty tiles stay the color key so whatever is under the map shows through
+     SDL_FillRect ( layer.surface, nullptr, SDL_MapRGB ( layer.surface->format, 255, 0, 255 ) );
+
+     // like world_to_sdl ( ) without the camera, the bottom row of tiles is the bottom of the layer
+     for ( Location tile; tile.y < static_cast<Int32>( map.height ( ) ); ++tile.y ) {
+          for ( tile.x = 0; tile.x < static_cast<Int32>( map.width ( ) ); ++tile.x ) {
+               Auto tile_value = map.get_tile_location_value ( tile );
+
+               if ( !tile_value || ( !invisibles && map.get_tile_location_invisible ( tile ) ) ) {
+                    continue;
+               }
+
+               SDL_Rect clip_rect { ( tile_value - 1 ) * Map::c_tile_dimension_in_pixels, 0,
+                                    Map::c_tile_dimension_in_pixels, Map::c_tile_dimension_in_pixels };
+               SDL_Rect dest_rect { tile.x * Map::c_tile_dimension_in_pixels,
+                                    height - ( tile.y + 1 ) * Map::c_tile_dimension_in_pixels,
+                                    Map::c_tile_dimension_in_pixels, Map::c_tile_dimension_in_pixels };
+
+               SDL_BlitSurface ( tilesheet, &clip_rect, layer.surface, &dest_rect );
+          }
+     }
+
+     for ( Uint8 i = 0; i < map.decor_count ( ); ++i ) {
+          const Auto& decor = map.decor ( i );
+          Location tile ( decor.coordinates );
+
+          if ( !invisibles && map.get_tile_location_invisible ( tile ) ) {
+               continue;
+          }
+
+          SDL_Rect clip_rect { decor.id * Map::c_tile_dimension_in_pixels, 0,
+                               Map::c_tile_dimension_in_pixels, Map::c_tile_dimension_in_pixels };
+          SDL_Rect dest_rect { tile.x * Map::c_tile_dimension_in_pixels,
+                               height - ( tile.y + 1 ) * Map::c_tile_dimension_in_pixels,
+                               Map::c_tile_dimension_in_pixels, Map::c_tile_dimension_in_pixels };
+
+          SDL_BlitSurface ( decorsheet, &clip_rect, layer.surface, &dest_rect );
+     }
+
+     layer.version = map.tile_version ( );
+     layer.invisibles = invisibles;
+     layer.stale = false;
+
+     return true;
+}
+
 Void MapDisplay::render ( SDL_Surface* back_buffer, Map& map, Real32 camera_x, Real32 camera_y,
                           Bool invisibles )
 {
-     if ( invisibles ) {
+     PROFILE_ZONE ( "MapDisplay::render" );
+
+     if ( bake_map_layer ( back_buffer, tilesheet, decorsheet, map, invisibles ) ) {
+          SDL_Surface* layer = g_map_layer.surface;
+
+          // one blit of the whole layer, sdl clips it to the part of the back buffer we can see
+          SDL_Rect dest_rect { meters_to_pixels ( camera_x ), meters_to_pixels ( camera_y ),
+                               layer->w, layer->h };
+
+          dest_rect.y = ( back_buffer->h - dest_rect.y ) - dest_rect.h;
+
+          SDL_BlitSurface ( layer, nullptr, back_buffer, &dest_rect );
+     } else if ( invisibles ) {
           render_map_with_invisibles ( back_buffer, tilesheet, map, camera_x, camera_y );
+          render_map_decor ( back_buffer, decorsheet, map, camera_x, camera_y, invisibles );
      } else {
           render_map ( back_buffer, tilesheet, map, camera_x, camera_y );
+          render_map_decor ( back_buffer, decorsheet, map, camera_x, camera_y, invisibles );
      }
 
-     render_map_decor ( back_buffer, decorsheet, map, camera_x, camera_y, invisibles );
      render_map_lamps ( back_buffer, lampsheet, map, camera_x, camera_y, invisibles,
                         lamp_animation.frame );
 }
 
-static Void blend_tile_light ( SDL_Surface* back_buffer, const Location& tile_bottom_left_pixel, Real32 light )
+// widest stretch of a row lit at once, wider back buffers are lit in pieces
+static const Int32 c_max_light_row_width = 1024;
+static const Int32 c_max_light_row_tiles = c_max_light_row_width / Map::c_tile_dimension_in_pixels + 2;
+
+// smooth light samples between tile centers in 1/32nds of a tile, a pixel is 2 of them
+static const Int32 c_light_fraction_bits = 5;
+static const Int32 c_light_fraction_one  = 1 << c_light_fraction_bits;
+
+static inline Int32 floor_divide ( Int32 value, Int32 divisor )
 {
-     Int32 max_x = tile_bottom_left_pixel.x + Map::c_tile_dimension_in_pixels;
-     Int32 max_y = tile_bottom_left_pixel.y + Map::c_tile_dimension_in_pixels;
+     return ( value >= 0 ) ? ( value / divisor ) : -( ( -value + divisor - 1 ) / divisor );
+}
 
-     Uint32* p_pixel = reinterpret_cast<Uint32*>( back_buffer->pixels );
-     p_pixel += tile_bottom_left_pixel.x + ( tile_bottom_left_pixel.y * back_buffer->w );
+// where the back buffer keeps each color of a tile's light, the bytes that aren't color are left alone
+struct LightChannels {
+     Uint32 red_shift;
+     Uint32 green_shift;
+     Uint32 blue_shift;
+     Uint32 untouched;
+};
 
-     for ( Location pixel = tile_bottom_left_pixel; pixel.y < max_y; ++pixel.y ) {
-          for ( pixel.x = tile_bottom_left_pixel.x; pixel.x < max_x; ++pixel.x ) {
-               if ( pixel.x < 0 || pixel.x > back_buffer->w ||
-                    pixel.y < 0 || pixel.y > back_buffer->h ) {
-                    ++p_pixel;
-                    continue;
-               }
+static LightChannels light_channels ( const SDL_PixelFormat* format )
+{
+     return LightChannels { format->Rshift, format->Gshift, format->Bshift,
+                            ~( format->Rmask | format->Gmask | format->Bmask ) };
+}
+
+static inline Uint32 light_to_pixel ( Uint32 red, Uint32 green, Uint32 blue, LightChannels channels )
+{
+     return ( red << channels.red_shift ) | ( green << channels.green_shift ) | ( blue << channels.blue_shift ) |
+            channels.untouched;
+}
+
+static inline Uint32 light_to_pixel ( Uint32 light, LightChannels channels )
+{
+     return light_to_pixel ( ( light >> 16 ) & 0xFF, ( light >> 8 ) & 0xFF, light & 0xFF, channels );
+}
+
+// the tile containing each pixel lights all of it
+static Void build_tile_light_row ( const Map& map, Int32 tile_y, Int32 map_x, Int32 count,
+                                   LightChannels channels, Uint32* lights )
+{
+     Int32 tile_x = floor_divide ( map_x, Map::c_tile_dimension_in_pixels );
+     Int32 pixel_x = map_x - tile_x * Map::c_tile_dimension_in_pixels;
+
+     for ( Int32 i = 0; i < count; ) {
+          Uint32 light = light_to_pixel ( map.get_tile_location_light_color ( Location ( tile_x, tile_y ) ), channels );
+          Int32 end = i + ( Map::c_tile_dimension_in_pixels - pixel_x );
+
+          if ( end > count ) {
+               end = count;
+          }
+
+          for ( ; i < end; ++i ) {
+               lights [ i ] = light;
+          }
+
+          pixel_x = 0;
+          tile_x++;
+     }
+}
+
+// bilinear between the centers of the 4 closest tiles, tiles past the edge of the map repeat the edge
+static Void build_smooth_light_row ( const Map& map, Int32 map_y, Int32 map_x, Int32 count,
+                                     LightChannels channels, Uint32* lights )
+{
+     Int32 half_tile = Map::c_tile_dimension_in_pixels / 2;
+     Int32 sample_y = ( map_y - half_tile ) * 2 + 1;
+     Int32 sample_x = ( map_x - half_tile ) * 2 + 1;
+
+     Int32 bottom = floor_divide ( sample_y, c_light_fraction_one );
+     Int32 fraction_y = sample_y - bottom * c_light_fraction_one;
+     Int32 top = bottom + 1;
+
+     CLAMP ( bottom, 0, map.height ( ) - 1 );
+     CLAMP ( top, 0, map.height ( ) - 1 );
+
+     // blend each channel of each column vertically once, then across it for each pixel
+     Int32 first_column = floor_divide ( sample_x, c_light_fraction_one );
+     Int32 last_column = floor_divide ( sample_x + ( count - 1 ) * 2, c_light_fraction_one ) + 1;
+     Uint32 columns [ c_max_light_row_tiles + 1 ][ 3 ];
 
-               // get the current pixel location
-               // read pixels
-               Uint8 red   = *( reinterpret_cast<Uint8*>( p_pixel ) );
-               Uint8 green = *( reinterpret_cast<Uint8*>( p_pixel ) + 1 );
-               Uint8 blue  = *( reinterpret_cast<Uint8*>( p_pixel ) + 2 );
+     for ( Int32 c = first_column; c <= last_column; ++c ) {
+          Int32 tile_x = c;
 
-               // blend
-               Real32 blended_red   = static_cast<Real32>( red ) * light;
-               Real32 blended_green = static_cast<Real32>( green ) * light;
-               Real32 blended_blue  = static_cast<Real32>( blue ) * light;
+          CLAMP ( tile_x, 0, map.width ( ) - 1 );
 
-               // write pixel
-               *( reinterpret_cast<Uint8*>( p_pixel ) )     = static_cast<Uint8>( blended_red );
-               *( reinterpret_cast<Uint8*>( p_pixel ) + 1 ) = static_cast<Uint8>( blended_green );
-               *( reinterpret_cast<Uint8*>( p_pixel ) + 2 ) = static_cast<Uint8>( blended_blue );
+          Uint32 bottom_light = map.get_tile_location_light_color ( Location ( tile_x, bottom ) );
+          Uint32 top_light = map.get_tile_location_light_color ( Location ( tile_x, top ) );
 
-               ++p_pixel;
+          for ( Int32 channel = 0; channel < 3; ++channel ) {
+               Uint32 shift = 16 - channel * 8;
+
+               columns [ c - first_column ][ channel ] =
+                    ( ( bottom_light >> shift ) & 0xFF ) * ( c_light_fraction_one - fraction_y ) +
+                    ( ( top_light >> shift ) & 0xFF ) * fraction_y;
           }
+     }
+
+     Int32 fraction_x = sample_x - first_column * c_light_fraction_one;
+     Int32 round = 1 << ( c_light_fraction_bits * 2 - 1 );
+     Int32 shift = c_light_fraction_bits * 2;
 
-          p_pixel += back_buffer->w;
-          p_pixel -= Map::c_tile_dimension_in_pixels;
+     // between two column centers each channel changes by the same amount every pixel
+     for ( Int32 i = 0, column = 0; i < count; ++column ) {
+          const Uint32* left = columns [ column ];
+          const Uint32* right = columns [ column + 1 ];
+          Int32 end = i + ( c_light_fraction_one - fraction_x + 1 ) / 2;
+
+          if ( end > count ) {
+               end = count;
+          }
+
+          Int32 red = left [ 0 ] * ( c_light_fraction_one - fraction_x ) + right [ 0 ] * fraction_x + round;
+          Int32 green = left [ 1 ] * ( c_light_fraction_one - fraction_x ) + right [ 1 ] * fraction_x + round;
+          Int32 blue = left [ 2 ] * ( c_light_fraction_one - fraction_x ) + right [ 2 ] * fraction_x + round;
+          Int32 red_step = ( static_cast<Int32>( right [ 0 ] ) - static_cast<Int32>( left [ 0 ] ) ) * 2;
+          Int32 green_step = ( static_cast<Int32>( right [ 1 ] ) - static_cast<Int32>( left [ 1 ] ) ) * 2;
+          Int32 blue_step = ( static_cast<Int32>( right [ 2 ] ) - static_cast<Int32>( left [ 2 ] ) ) * 2;
+
+          for ( ; i < end; ++i ) {
+               lights [ i ] = light_to_pixel ( red >> shift, green >> shift, blue >> shift, channels );
+
+               red += red_step;
+               green += green_step;
+               blue += blue_step;
+          }
+
+          fraction_x = 1;
      }
 }
 
-extern "C" Void render_light ( SDL_Surface* back_buffer, Map& map, Real32 camera_x, Real32 camera_y )
+extern "C" Void render_light ( SDL_Surface* back_buffer, Map& map, Real32 camera_x, Real32 camera_y, Bool smooth )
 {
+     PROFILE_ZONE ( "render_light" );
+
      // Lock the backbuffer, we are going to access it's pixels
      if ( SDL_LockSurface ( back_buffer ) ) {
           return;
      }
 
-     for ( Location tile; tile.y < static_cast<Int32>( map.height ( ) ); ++tile.y ) {
-          for ( tile.x = 0; tile.x < static_cast<Int32>( map.width ( ) ); ++tile.x ) {
-               Location tile_dest = tile;
+     Int32 offset_x = meters_to_pixels ( camera_x );
+     Int32 offset_y = meters_to_pixels ( camera_y );
 
-               Map::convert_tiles_to_pixels ( &tile_dest );
+     // only the part of each row covered by the map is lit
+     Int32 map_pixel_width = map.width ( ) * Map::c_tile_dimension_in_pixels;
+     Int32 map_pixel_height = map.height ( ) * Map::c_tile_dimension_in_pixels;
+     Int32 left = offset_x;
+     Int32 right = offset_x + map_pixel_width;
 
-               tile_dest.x += meters_to_pixels ( camera_x );
-               tile_dest.y += meters_to_pixels ( camera_y );
-               tile_dest.y = ( back_buffer->h - tile_dest.y ) - Map::c_tile_dimension_in_pixels;
+     CLAMP ( left, 0, back_buffer->w );
+     CLAMP ( right, 0, back_buffer->w );
 
-               // ignore off-screen light
-               if ( tile_dest.x < -Map::c_tile_dimension_in_pixels ||
-                    tile_dest.x > back_buffer->w ||
-                    tile_dest.y < -Map::c_tile_dimension_in_pixels ||
-                    tile_dest.y > back_buffer->h ) {
-                    continue;
-               }
+     LightChannels channels = light_channels ( back_buffer->format );
+     Uint32 lights [ c_max_light_row_width ];
+     Int32 built_tile_y = -1;
 
-               Uint8 pixel_light = map.get_tile_location_light ( tile );
-               Real32 normalized_pixel_light = static_cast<Real32>( pixel_light ) / 255.0f;
+     for ( Int32 y = 0; y < back_buffer->h; ++y ) {
+          // rows go down the screen, the map goes up it
+          Int32 map_y = back_buffer->h - 1 - y - offset_y;
+
+          if ( map_y < 0 || map_y >= map_pixel_height ) {
+               continue;
+          }
+
+          Int32 tile_y = map_y / Map::c_tile_dimension_in_pixels;
+          Uint32* row = reinterpret_cast<Uint32*>( reinterpret_cast<Uint8*>( back_buffer->pixels ) +
+                                                   y * back_buffer->pitch );
+
+          for ( Int32 x = left; x < right; x += c_max_light_row_width ) {
+               Int32 count = ( right - x < c_max_light_row_width ) ? right - x : c_max_light_row_width;
+
+               if ( smooth ) {
+                    build_smooth_light_row ( map, map_y, x - offset_x, count, channels, lights );
+               } else if ( tile_y != built_tile_y || right - left > c_max_light_row_width ) {
+                    // every row of pixels in a row of tiles gets the same light
+                    build_tile_light_row ( map, tile_y, x - offset_x, count, channels, lights );
+                    built_tile_y = tile_y;
+               }
 
-               blend_tile_light ( back_buffer, tile_dest, normalized_pixel_light );
+               blend_light_row ( row + x, lights, count );
           }
      }
 
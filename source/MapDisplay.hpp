@@ -38,7 +38,9 @@ namespace bryte
           Animation lamp_animation;
      };
 
-     extern "C" Void render_light ( SDL_Surface* back_buffer, Map& map, Real32 camera_x, Real32 camera_y );
+     // smooth blends between tile centers rather than lighting each tile evenly
+     extern "C" Void render_light ( SDL_Surface* back_buffer, Map& map, Real32 camera_x, Real32 camera_y,
+                                    Bool smooth );
 }
 
 #endif
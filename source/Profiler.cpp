@@ -0,0 +1,148 @@
+#include "Profiler.hpp"
+#include "Log.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <cstdio>
+#include <cstring>
+
+using namespace bryte;
+
+Profiler* Profiler::active = nullptr;
+
+Void Profiler::clear ( )
+{
+     for ( Uint32 i = 0; i < c_max_frame_count; ++i ) {
+          m_frames [ i ].zone_count = 0;
+          m_frames [ i ].dropped_zone_count = 0;
+     }
+
+     m_current_frame = 0;
+     m_recorded_frame_count = 0;
+     m_depth = 0;
+}
+
+Int32 Profiler::begin_zone ( const Char8* name )
+{
+     ProfileFrame& frame = m_frames [ m_current_frame ];
+
+     if ( frame.zone_count >= ProfileFrame::c_max_zone_count || m_depth >= c_max_depth ) {
+          frame.dropped_zone_count++;
+          return -1;
+     }
+
+     Int32 index = frame.zone_count;
+     ProfileZone& zone = frame.zones [ index ];
+
+     strncpy ( zone.name, name, ProfileZone::c_max_name_length - 1 );
+     zone.name [ ProfileZone::c_max_name_length - 1 ] = '\0';
+
+     zone.depth = m_depth;
+     zone.end   = 0;
+
+     frame.zone_count++;
+     m_depth++;
+
+     zone.start = SDL_GetPerformanceCounter ( );
+
+     return index;
+}
+
+Void Profiler::end_zone ( Int32 zone_index )
+{
+     Uint64 now = SDL_GetPerformanceCounter ( );
+
+     if ( zone_index < 0 ) {
+          return;
+     }
+
+     // the frame may have been ended while this zone was open
+     ProfileFrame& frame = m_frames [ m_current_frame ];
+
+     if ( static_cast<Uint32>( zone_index ) >= frame.zone_count ) {
+          return;
+     }
+
+     frame.zones [ zone_index ].end = now;
+
+     if ( m_depth ) {
+          m_depth--;
+     }
+}
+
+Void Profiler::end_frame ( )
+{
+     m_current_frame = ( m_current_frame + 1 ) % c_max_frame_count;
+
+     if ( m_recorded_frame_count < c_max_frame_count ) {
+          m_recorded_frame_count++;
+     }
+
+     m_frames [ m_current_frame ].zone_count = 0;
+     m_frames [ m_current_frame ].dropped_zone_count = 0;
+     m_depth = 0;
+}
+
+Bool Profiler::export_chrome_trace ( const Char8* path ) const
+{
+     FILE* file = fopen ( path, "w" );
+
+     if ( !file ) {
+          LOG_ERROR ( "Failed to open '%s' to write profile trace\n", path );
+          return false;
+     }
+
+     Real64 us_per_tick = 1000000.0 / static_cast<Real64>( SDL_GetPerformanceFrequency ( ) );
+
+     // start from the oldest completed frame, the current frame is still being recorded
+     Uint32 first_frame = ( m_current_frame + c_max_frame_count - m_recorded_frame_count ) % c_max_frame_count;
+     Uint64 base_ticks = 0;
+     Bool   found_base = false;
+     Bool   first_event = true;
+     Uint32 dropped = 0;
+
+     fprintf ( file, "{\"traceEvents\":[\n" );
+
+     for ( Uint32 f = 0; f < m_recorded_frame_count; ++f ) {
+          const ProfileFrame& frame = m_frames [ ( first_frame + f ) % c_max_frame_count ];
+
+          dropped += frame.dropped_zone_count;
+
+          for ( Uint32 z = 0; z < frame.zone_count; ++z ) {
+               const ProfileZone& zone = frame.zones [ z ];
+
+               // skip zones that never closed
+               if ( zone.end < zone.start ) {
+                    continue;
+               }
+
+               if ( !found_base ) {
+                    base_ticks = zone.start;
+                    found_base = true;
+               }
+
+               Real64 timestamp = static_cast<Real64>( zone.start - base_ticks ) * us_per_tick;
+               Real64 duration  = static_cast<Real64>( zone.end - zone.start ) * us_per_tick;
+
+               fprintf ( file, "%s{\"name\":\"%s\",\"cat\":\"frame%u\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                         "\"pid\":1,\"tid\":1}",
+                         first_event ? "" : ",\n", zone.name, f, timestamp, duration );
+
+               first_event = false;
+          }
+     }
+
+     fprintf ( file, "\n]}\n" );
+
+     fclose ( file );
+
+     LOG_INFO ( "Wrote %u profiled frames to '%s'\n", m_recorded_frame_count, path );
+
+     if ( dropped ) {
+          LOG_WARNING ( "%u profile zones were dropped, frames exceeded %u zones or %u depth\n",
+                        dropped, ProfileFrame::c_max_zone_count, c_max_depth );
+     }
+
+     return true;
+}
+
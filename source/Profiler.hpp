@@ -0,0 +1,92 @@
+#ifndef BRYTE_PROFILER_HPP
+#define BRYTE_PROFILER_HPP
+
+#include "Types.hpp"
+
+namespace bryte
+{
+     struct ProfileZone {
+          static const Uint32 c_max_name_length = 32;
+
+          // names are copied so they outlive a reload of the code that recorded them
+          Char8  name [ c_max_name_length ];
+          Uint64 start;
+          Uint64 end;
+          Uint32 depth;
+     };
+
+     struct ProfileFrame {
+          static const Uint32 c_max_zone_count = 256;
+
+          ProfileZone zones [ c_max_zone_count ];
+          Uint32      zone_count;
+          Uint32      dropped_zone_count;
+     };
+
+     // records nested zones into a ring of frames, lives in game memory so it survives a reload
+     class Profiler {
+     public:
+
+          Void clear ( );
+
+          Int32 begin_zone ( const Char8* name );
+          Void end_zone ( Int32 zone_index );
+
+          Void end_frame ( );
+
+          // writes every recorded frame as chrome://tracing json
+          Bool export_chrome_trace ( const Char8* path ) const;
+
+     public:
+
+          static const Uint32 c_max_frame_count = 64;
+          static const Uint32 c_max_depth = 16;
+
+          // set by each game entry point, zones recorded while it is null are dropped
+          static Profiler* active;
+
+     private:
+
+          ProfileFrame m_frames [ c_max_frame_count ];
+
+          Uint32 m_current_frame;
+          Uint32 m_recorded_frame_count;
+          Uint32 m_depth;
+     };
+
+     class ScopedProfileZone {
+     public:
+
+          inline ScopedProfileZone ( const Char8* name );
+          inline ~ScopedProfileZone ( );
+
+     private:
+
+          Int32 m_zone_index;
+     };
+
+     inline ScopedProfileZone::ScopedProfileZone ( const Char8* name ) :
+          m_zone_index ( Profiler::active ? Profiler::active->begin_zone ( name ) : -1 )
+     {
+
+     }
+
+     inline ScopedProfileZone::~ScopedProfileZone ( )
+     {
+          if ( Profiler::active ) {
+               Profiler::active->end_zone ( m_zone_index );
+          }
+     }
+}
+
+#define PROFILE_CONCAT_IMPL( a, b ) a ## b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_IMPL( a, b )
+
+#ifdef PROFILE
+     #define PROFILE_ZONE( name ) bryte::ScopedProfileZone PROFILE_CONCAT( profile_zone_, __LINE__ ) ( name )
+#else
+     #define PROFILE_ZONE( name )
+#endif
+
+#endif
+
@@ -3,6 +3,8 @@
 #include "Interactives.hpp"
 #include "Utils.hpp"
 
+#include <cmath>
+
 using namespace bryte;
 
 const Real32 Projectile::c_arrow_speed = 20.0f;
@@ -12,7 +14,7 @@ const Real32 Projectile::c_stuck_time = 1.5f;
 
 Vector Projectile::collision_points [ Direction::count ];
 
-Int32 Projectile::hit_character ( Character& character )
+Int32 Projectile::hit_character ( Character& character, const EntityHandle& character_handle )
 {
      Int32 damage_amount = 1;
 
@@ -23,7 +25,7 @@ Int32 Projectile::hit_character ( Character& character )
      default:
           break;
      case Type::arrow:
-          track_entity.entity = &character;
+          track_entity.entity = character_handle;
           track_entity.offset = position - character.position;
           stuck_watch.reset ( Projectile::c_stuck_time );
           break;
@@ -75,7 +77,7 @@ Bool Projectile::check_for_solids ( const Map& map, Interactives& interactives )
           current_tile = map.location_to_tile_index ( tile );
      }
 
-     Auto& interactive = interactives.get_from_tile ( tile );
+     const Auto& interactive = interactives.cget_from_tile ( tile );
      if ( interactive.type == Interactive::Type::exit ) {
           // otherwise arrows can escape when doors are open
           // TODO: is this ok?
@@ -93,14 +95,86 @@ Bool Projectile::check_for_solids ( const Map& map, Interactives& interactives )
      return false;
 }
 
-Void Projectile::update ( float time_delta, const Map& map, Interactives& interactives  )
+// fraction of change it takes to go from a position to the next tile edge along one axis
+static Real32 fraction_to_next_tile_edge ( Real32 from, Real32 change )
+{
+     if ( change == 0.0f ) {
+          return 2.0f;
+     }
+
+     Real32 edge = floorf ( from / Map::c_tile_dimension_in_meters ) * Map::c_tile_dimension_in_meters;
+
+     if ( change > 0.0f ) {
+          edge += Map::c_tile_dimension_in_meters;
+     }
+
+     return ( edge - from ) / change;
+}
+
+Bool Projectile::move ( Vector change, const Map& map, Interactives& interactives )
+{
+     // how far past an edge to step so the center is clearly in the next tile
+     static const Real32 c_edge_nudge = 0.01f;
+     static const Int32 c_max_tile_steps = 64;
+
+     Vector half_tile { Map::c_tile_dimension_in_meters * 0.5f, Map::c_tile_dimension_in_meters * 0.5f };
+
+     // walk the center across every tile edge between here and the destination, a long step
+     // can't skip over a solid tile that way
+     for ( Int32 i = 0; i < c_max_tile_steps; ++i ) {
+          Real32 length = change.length ( );
+
+          if ( length == 0.0f ) {
+               break;
+          }
+
+          Vector center = position + half_tile;
+
+          Real32 fraction_x = fraction_to_next_tile_edge ( center.x ( ), change.x ( ) );
+          Real32 fraction_y = fraction_to_next_tile_edge ( center.y ( ), change.y ( ) );
+          Real32 fraction = ( fraction_x < fraction_y ? fraction_x : fraction_y ) + c_edge_nudge / length;
+
+          if ( fraction >= 1.0f ) {
+               break;
+          }
+
+          Vector step = change * fraction;
+
+          position += step;
+          change -= step;
+
+          Vector stepped_position = position;
+
+          if ( check_for_solids ( map, interactives ) ) {
+               // end up where a single step would have if it stops in the same tile
+               if ( position == stepped_position &&
+                    Map::vector_to_location ( position + change + half_tile ) ==
+                    Map::vector_to_location ( position + half_tile ) ) {
+                    position += change;
+               }
+
+               return true;
+          }
+
+          if ( is_dead ( ) ) {
+               return false;
+          }
+     }
+
+     position += change;
+
+     return check_for_solids ( map, interactives );
+}
+
+Void Projectile::update ( float time_delta, const Map& map, Interactives& interactives,
+                          const Entity* tracked )
 {
      switch ( type ) {
      default:
           ASSERT ( 0 );
           break;
      case Type::arrow:
-          update_arrow ( time_delta, map, interactives );
+          update_arrow ( time_delta, map, interactives, tracked );
           break;
      case Type::goo:
           update_goo ( time_delta, map, interactives );
@@ -111,7 +185,8 @@ Void Projectile::update ( float time_delta, const Map& map, Interactives& intera
      }
 }
 
-Void Projectile::update_arrow ( float time_delta, const Map& map, Interactives& interactives )
+Void Projectile::update_arrow ( float time_delta, const Map& map, Interactives& interactives,
+                                const Entity* tracked )
 {
      switch ( life_state ) {
      default:
@@ -125,16 +200,14 @@ Void Projectile::update_arrow ( float time_delta, const Map& map, Interactives&
           break;
      case LifeState::alive:
           if ( stuck_watch.expired ( ) ) {
-               position += vector_from_direction ( facing ) * c_arrow_speed * time_delta;
-
-               if ( check_for_solids ( map, interactives ) ) {
+               if ( move ( vector_from_direction ( facing ) * c_arrow_speed * time_delta, map, interactives ) ) {
                     stuck_watch.reset ( c_stuck_time );
                }
           } else {
                stuck_watch.tick ( time_delta );
 
-               if ( track_entity.entity ) {
-                    position = track_entity.entity->position + track_entity.offset;
+               if ( tracked ) {
+                    position = tracked->position + track_entity.offset;
                }
 
                if ( stuck_watch.expired ( ) ) {
@@ -159,9 +232,7 @@ Void Projectile::update_goo ( float time_delta, const Map& map, Interactives& in
           life_state = LifeState::alive;
           break;
      case LifeState::alive:
-          position += vector_from_direction ( facing ) * c_goo_speed * time_delta;
-
-          if ( check_for_solids ( map, interactives ) ) {
+          if ( move ( vector_from_direction ( facing ) * c_goo_speed * time_delta, map, interactives ) ) {
                stuck_watch.reset ( c_stuck_time );
                life_state = dead;
                clear ( );
@@ -183,9 +254,7 @@ Void Projectile::update_ice ( float time_delta, const Map& map, Interactives& in
           life_state = LifeState::alive;
           break;
      case LifeState::alive:
-          position += vector_from_direction ( facing ) * c_ice_speed * time_delta;
-
-          if ( check_for_solids ( map, interactives ) ) {
+          if ( move ( vector_from_direction ( facing ) * c_ice_speed * time_delta, map, interactives ) ) {
                stuck_watch.reset ( c_stuck_time );
                life_state = dead;
                clear ( );
@@ -199,7 +268,7 @@ Void Projectile::clear ( )
      type = Type::arrow;
      facing = Direction::left;
      stuck_watch.reset ( 0.0f );
-     track_entity.entity = nullptr;
+     track_entity.entity = null_entity_handle ( );
      track_entity.offset.zero ( );
      position.zero ( );
      current_tile = 0;
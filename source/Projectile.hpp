@@ -26,14 +26,18 @@ namespace bryte
 
      public:
 
-          Int32 hit_character ( Character& character );
-          Void update ( float dt, const Map& map, Interactives& interactives );
+          // arrows stick to the character they hit and follow it while its handle resolves
+          Int32 hit_character ( Character& character, const EntityHandle& character_handle );
+          Void update ( float dt, const Map& map, Interactives& interactives, const Entity* tracked );
           Bool check_for_solids ( const Map& map, Interactives& interactives );
+
+          // moves by change one tile at a time, stops in the first solid tile along the way
+          Bool move ( Vector change, const Map& map, Interactives& interactives );
           Void clear ( );
 
      private:
 
-          Void update_arrow ( float dt, const Map& map, Interactives& interactives );
+          Void update_arrow ( float dt, const Map& map, Interactives& interactives, const Entity* tracked );
           Void update_goo ( float dt, const Map& map, Interactives& interactives );
           Void update_ice ( float dt, const Map& map, Interactives& interactives );
 
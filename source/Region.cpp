@@ -67,6 +67,15 @@ Bool Region::load_info ( Int32 index )
      ss >> tmp_string;
      strncpy ( destructablesheet_filepath, tmp_string.c_str ( ), c_max_filepath_length );
 
+     // lamp colors are optional hex after the sheets, any left off are white
+     for ( Int32 i = 0; i < Map::c_unique_lamp_count; ++i ) {
+          if ( !( ss >> std::hex >> lamp_colors [ i ] ) ) {
+               lamp_colors [ i ] = Map::c_white_lamp;
+          }
+
+          lamp_colors [ i ] &= Map::c_white_lamp;
+     }
+
      // do a bit of error checking
      if ( !strlen ( name ) ) {
           LOG_ERROR ( "Empty name\n" );
@@ -111,6 +120,10 @@ Bool Region::load_info ( Int32 index )
      LOG_INFO ( " exitsheet: '%s'\n", exitsheet_filepath );
      LOG_INFO ( " destructablesheet: '%s'\n", exitsheet_filepath );
 
+     for ( Int32 i = 0; i < Map::c_unique_lamp_count; ++i ) {
+          LOG_INFO ( " lamp %d color: %06X\n", i, lamp_colors [ i ] );
+     }
+
      current_index = index;
 
      return true;
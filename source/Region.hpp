@@ -2,6 +2,7 @@
 #define BRYTE_REGION_HPP
 
 #include "Types.hpp"
+#include "Map.hpp"
 
 namespace bryte {
      struct Region {
@@ -27,6 +28,9 @@ namespace bryte {
           Char8 lampsheet_filepath [ c_max_filepath_length ];
           Char8 exitsheet_filepath [ c_max_filepath_length ];
           Char8 destructablesheet_filepath [ c_max_filepath_length ];
+
+          // rgb for each lamp id, lamps in maps saved without their own colors use these
+          Uint32 lamp_colors [ Map::c_unique_lamp_count ];
      };
 }
 
@@ -0,0 +1,324 @@
+#include <cstdio>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+
+#include "Simulation.hpp"
+#include "Benchmark.hpp"
+#include "Bryte.hpp"
+
+struct SimSettings {
+     const Char8* shared_library_path;
+
+     Uint32       game_memory_allocation_size;
+     Uint32       game_memory_warning_threshold;
+
+     Int32        back_buffer_width;
+     Int32        back_buffer_height;
+
+     Uint32       simulation_frames_per_second;
+
+     Uint32       frame_count;
+
+     // replay a recording as a benchmark rather than simulating from the title screen
+     Bool         benchmark;
+     const Char8* benchmark_memory_path;
+     const Char8* benchmark_input_path;
+     const Char8* benchmark_report_path;
+};
+
+Void print_help ( )
+{
+     printf ( "Bryte headless simulation\n" );
+     printf ( "Usage: ./bryte_sim [ options ]\n" );
+     printf ( "  -r region info index\n" );
+     printf ( "  -i map index to load from master list\n" );
+     printf ( "  -x tile x to spawn player on\n" );
+     printf ( "  -y tile y to spawn player on\n" );
+     printf ( "  -q pool capacity, pool is enemies, pickups, projectiles, bombs or emitters\n" );
+     printf ( "  -s stress, keeps %u enemies and %u projectiles alive, -q after it changes those\n",
+              bryte::Settings::c_stress_max_enemies, bryte::Settings::c_stress_max_projectiles );
+     printf ( "  -l smooth light, blends between tiles rather than lighting each one evenly\n" );
+     printf ( "  -w tile walls, characters collide against every solid tile rather than merged walls\n" );
+     printf ( "  -n number of frames to simulate, 900 by default\n" );
+     printf ( "  -b replay a recorded session as fast as possible and report frame timings\n" );
+     printf ( "  -m game memory snapshot the benchmark starts from, bryte_memory.mem by default\n" );
+     printf ( "  -p recorded input the benchmark replays, bryte_input.in by default\n" );
+     printf ( "  -o file to write the benchmark report to, bryte_benchmark.json by default\n" );
+     printf ( "  -h displays this helpful information\n\n" );
+}
+
+static Bool init_sdl ( )
+{
+     // NOTE: the game still loads and plays sounds, send them to a device that goes nowhere
+     SDL_setenv ( "SDL_AUDIODRIVER", "dummy", 1 );
+
+     LOG_INFO ( "Initializing SDL: Audio\n" );
+
+     if ( SDL_Init ( SDL_INIT_AUDIO ) ) {
+          LOG_ERROR ( "SDL_Init() failed: %s\n", SDL_GetError ( ) );
+          return false;
+     }
+
+     LOG_INFO ( "Initializing SDL_Mixer\n" );
+
+     if ( Mix_OpenAudio ( 44100, MIX_DEFAULT_FORMAT, 2, 1024 ) ) {
+          LOG_ERROR ( "Mix_OpenAudio() failed: %s\n", Mix_GetError ( ) );
+          return false;
+     }
+
+     return true;
+}
+
+static Bool quit_requested ( )
+{
+     SDL_Event sdl_event = {};
+
+     while ( SDL_PollEvent ( &sdl_event ) ) {
+          if ( sdl_event.type == SDL_QUIT ) {
+               return true;
+          }
+     }
+
+     return false;
+}
+
+static Bool run_simulation ( const SimSettings& settings, Void* game_settings )
+{
+     SDL_Surface* back_buffer = SDL_CreateRGBSurface ( 0, settings.back_buffer_width, settings.back_buffer_height, 32,
+                                                       0x00FF0000, 0x0000FF00, 0x000000FF, 0 );
+
+     if ( !back_buffer ) {
+          LOG_ERROR ( "SDL_CreateRGBSurface() failed: %s\n", SDL_GetError ( ) );
+          return false;
+     }
+
+     Simulation simulation;
+
+     if ( !simulation.load ( settings.shared_library_path, settings.game_memory_allocation_size,
+                             settings.game_memory_warning_threshold, game_settings ) ) {
+          SDL_FreeSurface ( back_buffer );
+          return false;
+     }
+
+     simulation.set_snapshots_enabled ( false );
+
+     Real32   time_delta  = 1.0f / static_cast<Real32>( settings.simulation_frames_per_second );
+     Uint32   clear_color = 0;
+     SDL_Rect clear_rect { 0, 0, back_buffer->w, back_buffer->h };
+
+     GameInput game_input;
+
+     // get past the title screen by picking the first save slot
+     game_input.add_key_change ( SDL_SCANCODE_RETURN, true );
+
+     LOG_INFO ( "Simulating %u frames\n", settings.frame_count );
+
+     Uint64 start = SDL_GetPerformanceCounter ( );
+     Uint32 frame = 0;
+
+     for ( ; frame < settings.frame_count; ++frame ) {
+          simulation.update ( game_input, time_delta );
+          game_input.reset ( );
+
+          SDL_FillRect ( back_buffer, &clear_rect, clear_color );
+          simulation.render ( back_buffer, 1.0f );
+
+          if ( quit_requested ( ) ) {
+               break;
+          }
+     }
+
+     Real64 seconds = static_cast<Real64>( SDL_GetPerformanceCounter ( ) - start ) /
+                      static_cast<Real64>( SDL_GetPerformanceFrequency ( ) );
+
+     LOG_INFO ( "Simulated %u frames in %.3f seconds, %.1f frames per second\n",
+                frame, seconds, seconds > 0.0 ? static_cast<Real64>( frame ) / seconds : 0.0 );
+
+     simulation.log_memory_usage ( );
+
+     simulation.destroy ( );
+
+     SDL_FreeSurface ( back_buffer );
+
+     return true;
+}
+
+static Bool run_benchmark ( const SimSettings& settings, Void* game_settings )
+{
+     SDL_Surface* back_buffer = SDL_CreateRGBSurface ( 0, settings.back_buffer_width, settings.back_buffer_height, 32,
+                                                       0x00FF0000, 0x0000FF00, 0x000000FF, 0 );
+
+     if ( !back_buffer ) {
+          LOG_ERROR ( "SDL_CreateRGBSurface() failed: %s\n", SDL_GetError ( ) );
+          return false;
+     }
+
+     Simulation    simulation;
+     InputRecorder input_recorder;
+     Benchmark     benchmark;
+
+     Bool success = simulation.load ( settings.shared_library_path, settings.game_memory_allocation_size,
+                                      settings.game_memory_warning_threshold, game_settings ) &&
+                    simulation.load_snapshot ( settings.benchmark_memory_path, game_settings ) &&
+                    input_recorder.start_playing_back ( settings.benchmark_input_path ) &&
+                    benchmark.start ( Benchmark::c_default_max_frame_count );
+
+     if ( success ) {
+          simulation.set_snapshots_enabled ( false );
+
+          Real32   time_delta  = 1.0f / static_cast<Real32>( settings.simulation_frames_per_second );
+          Uint32   clear_color = 0;
+          SDL_Rect clear_rect { 0, 0, back_buffer->w, back_buffer->h };
+
+          GameInput game_input;
+
+          LOG_INFO ( "Replaying '%s' from '%s'\n", settings.benchmark_input_path, settings.benchmark_memory_path );
+
+          while ( !benchmark.full ( ) && input_recorder.read_frame ( game_input ) ) {
+               benchmark.begin_stage ( Benchmark::Stage::update );
+               simulation.update ( game_input, time_delta );
+               benchmark.end_stage ( Benchmark::Stage::update );
+
+               benchmark.begin_stage ( Benchmark::Stage::render );
+               SDL_FillRect ( back_buffer, &clear_rect, clear_color );
+               simulation.render ( back_buffer, 1.0f );
+               benchmark.end_stage ( Benchmark::Stage::render );
+
+               benchmark.end_frame ( );
+
+               if ( quit_requested ( ) ) {
+                    break;
+               }
+          }
+
+          input_recorder.stop_playing_back ( );
+
+          success = benchmark.write_report ( settings.benchmark_report_path, true );
+     }
+
+     simulation.destroy ( );
+
+     SDL_FreeSurface ( back_buffer );
+
+     return success;
+}
+
+Int32 main ( Int32 argc, Char8** argv )
+{
+     SimSettings settings;
+
+     settings.shared_library_path           = "./bryte_game.so";
+
+     settings.game_memory_allocation_size   = MEGABYTES ( 32 );
+     settings.game_memory_warning_threshold = GameMemory::c_default_warning_threshold;
+
+     settings.back_buffer_width             = 256;
+     settings.back_buffer_height            = 240;
+
+     settings.simulation_frames_per_second  = 30;
+
+     settings.frame_count                   = 900;
+
+     settings.benchmark                     = false;
+     settings.benchmark_memory_path         = Simulation::c_game_memory_filepath;
+     settings.benchmark_input_path          = Simulation::c_record_input_filepath;
+     settings.benchmark_report_path         = "bryte_benchmark.json";
+
+     bryte::Settings bryte_settings;
+
+     bryte_settings.region_index = 0;
+     bryte_settings.map_index = 0;
+     bryte_settings.player_spawn_tile_x = 6;
+     bryte_settings.player_spawn_tile_y = 2;
+     bryte_settings.default_capacities ( );
+     bryte_settings.smooth_light = false;
+     bryte_settings.merged_walls = true;
+
+     for ( int i = 1; i < argc; ++i ) {
+          if ( strcmp ( argv [ i ], "-h" ) == 0 ) {
+               print_help ( );
+               return 0;
+          } else if ( strcmp ( argv [ i ], "-r" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    bryte_settings.region_index = atoi ( argv [ i + 1 ] );
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-i" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    bryte_settings.map_index = atoi ( argv [ i + 1 ] );
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-x" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    bryte_settings.player_spawn_tile_x = atoi ( argv [ i + 1 ] );
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-y" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    bryte_settings.player_spawn_tile_y = atoi ( argv [ i + 1 ] );
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-q" ) == 0 ) {
+               if ( argc > i + 2 ) {
+                    if ( !bryte_settings.set_capacity ( argv [ i + 1 ], atoi ( argv [ i + 2 ] ) ) ) {
+                         printf ( "unrecognized pool: %s, see help.\n", argv [ i + 1 ] );
+                         return 0;
+                    }
+                    i += 2;
+               }
+          } else if ( strcmp ( argv [ i ], "-s" ) == 0 ) {
+               bryte_settings.enable_stress ( );
+          } else if ( strcmp ( argv [ i ], "-l" ) == 0 ) {
+               bryte_settings.smooth_light = true;
+          } else if ( strcmp ( argv [ i ], "-w" ) == 0 ) {
+               bryte_settings.merged_walls = false;
+          } else if ( strcmp ( argv [ i ], "-n" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.frame_count = atoi ( argv [ i + 1 ] );
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-b" ) == 0 ) {
+               settings.benchmark = true;
+          } else if ( strcmp ( argv [ i ], "-m" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.benchmark_memory_path = argv [ i + 1 ];
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-p" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.benchmark_input_path = argv [ i + 1 ];
+                    ++i;
+               }
+          } else if ( strcmp ( argv [ i ], "-o" ) == 0 ) {
+               if ( argc >= i + 1 ) {
+                    settings.benchmark_report_path = argv [ i + 1 ];
+                    ++i;
+               }
+          } else {
+               printf ( "unrecognized option: %s, see help.\n", argv [ i ] );
+               return 0;
+          }
+     }
+
+     // the entity pools come out of game memory, grow it for any too big for the default
+     Uint32 needed_memory = bryte::State::game_memory_bytes ( bryte_settings );
+
+     if ( settings.game_memory_allocation_size < needed_memory ) {
+          LOG_INFO ( "Growing game memory to %u bytes to fit the entity pools\n", needed_memory );
+          settings.game_memory_allocation_size = needed_memory;
+     }
+
+     if ( !init_sdl ( ) ) {
+          return 1;
+     }
+
+     Bool success = settings.benchmark ? run_benchmark ( settings, &bryte_settings ) :
+                                         run_simulation ( settings, &bryte_settings );
+
+     Mix_CloseAudio ( );
+     SDL_Quit ( );
+
+     return success ? 0 : 1;
+}
+
@@ -0,0 +1,590 @@
+#include "Simulation.hpp"
+#include "Utils.hpp"
+
+#include <fstream>
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef LINUX
+     #include <sys/mman.h>
+     #include <sys/stat.h>
+     #include <fcntl.h>
+     #include <unistd.h>
+#endif
+
+const Char8* Simulation::c_game_memory_filepath  = "bryte_memory.mem";
+const Char8* Simulation::c_record_input_filepath = "bryte_input.in";
+
+// NOTE: the game keeps pointers into its memory, so snapshots only make sense if the memory sits at
+//       the same address in every run that loads them
+static const Uint64 c_game_memory_base_address = 0x100000000000;
+
+static const Uint32 c_snapshot_magic = 0x324D5242; // 'BRM2'
+
+// NOTE: only the bytes the game has pushed follow the header
+struct SnapshotHeader {
+     Uint32 magic;
+     Uint32 size;
+     Uint32 used;
+     Uint32 reserved;
+     Uint64 base_address;
+};
+
+Simulation::Simulation ( ) :
+     m_frame               ( 0 ),
+     m_playback_loop_count ( 0 ),
+     m_last_time_delta     ( 0.0f ),
+     m_snapshots_enabled   ( true ),
+     m_shared_library_path ( nullptr ),
+     m_game_initialized    ( false ),
+     m_snapshot_file       ( -1 ),
+     m_snapshot            ( nullptr ),
+     m_snapshot_size       ( 0 ),
+     m_snapshot_writable   ( false )
+{
+     m_snapshot_path [ 0 ] = '\0';
+}
+
+Simulation::~Simulation ( )
+{
+     destroy ( );
+     unmap_snapshot ( );
+     free_game_memory ( );
+}
+
+Bool Simulation::load ( const Char8* shared_library_path, Uint32 game_memory_allocation_size,
+                        Uint32 game_memory_warning_threshold, Void* game_settings )
+{
+     m_shared_library_path = shared_library_path;
+
+     if ( !m_game_functions.load ( shared_library_path ) ) {
+          return false;
+     }
+
+     if ( !allocate_game_memory ( game_memory_allocation_size ) ) {
+          return false;
+     }
+
+     m_game_memory.set_warning_threshold ( game_memory_warning_threshold );
+
+     if ( !m_snapshot_ring.start ( SnapshotRing::c_default_capacity,
+                                   SnapshotRing::c_default_keyframe_interval ) ) {
+          return false;
+     }
+
+     m_frame = 0;
+
+     LOG_INFO ( "Initializing game\n" );
+     if ( !m_game_functions.game_init_func ( m_game_memory, game_settings ) ) {
+          return false;
+     }
+
+     m_game_initialized = true;
+
+     return true;
+}
+
+Void Simulation::destroy ( )
+{
+     if ( m_game_initialized ) {
+          LOG_INFO ( "Destroying game\n" );
+          m_game_functions.game_destroy_func ( m_game_memory );
+          m_game_initialized = false;
+     }
+}
+
+Bool Simulation::reload_game_code ( )
+{
+     return m_game_functions.load ( m_shared_library_path );
+}
+
+Void Simulation::update ( GameInput& game_input, Real32 time_delta )
+{
+     if ( m_frame % c_snapshot_frame_interval == 0 ) {
+          take_snapshot ( );
+     }
+
+     if ( m_input_recorder.is_recording ( ) ) {
+          m_input_recorder.write_frame ( game_input );
+     }
+
+     if ( m_input_recorder.is_playing_back ( ) ) {
+          if ( !m_input_recorder.read_frame ( game_input ) ) {
+               if ( load_game_memory ( c_game_memory_filepath ) ) {
+                    resume_game ( );
+               }
+
+               m_frame = 0;
+               m_playback_loop_count++;
+               m_snapshot_ring.clear ( );
+               take_snapshot ( );
+
+               m_input_recorder.read_frame ( game_input );
+          }
+     }
+
+     m_game_memory.begin_frame ( );
+
+     m_game_functions.game_user_input_func ( m_game_memory, game_input );
+     m_game_functions.game_update_func ( m_game_memory, time_delta );
+
+     m_last_time_delta = time_delta;
+     m_frame++;
+}
+
+Void Simulation::log_memory_usage ( )
+{
+     LOG_INFO ( "Game memory: %u of %u bytes held between frames\n", m_game_memory.used ( ), m_game_memory.size ( ) );
+
+     for ( Uint32 i = 0; i < GameMemory::Arena::count; ++i ) {
+          Auto arena = static_cast<GameMemory::Arena>( i );
+          Auto usage = m_game_memory.usage ( arena );
+
+          LOG_INFO ( "  %-12s %10u used %10u high water %10u this frame of %10u\n",
+                     GameMemory::arena_name ( arena ), usage.used, usage.high_water,
+                     usage.frame_high_water, usage.capacity );
+     }
+
+     // largest first, so whichever subsystem holds the most memory tops the list
+     GameMemory::Tag tags [ GameMemory::Tag::tag_count ];
+
+     for ( Uint32 i = 0; i < GameMemory::Tag::tag_count; ++i ) {
+          Auto tag = static_cast<GameMemory::Tag>( i );
+          Uint32 high_water = m_game_memory.tag_high_water ( tag );
+          Uint32 t = i;
+
+          while ( t > 0 && m_game_memory.tag_high_water ( tags [ t - 1 ] ) < high_water ) {
+               tags [ t ] = tags [ t - 1 ];
+               t--;
+          }
+
+          tags [ t ] = tag;
+     }
+
+     for ( Uint32 i = 0; i < GameMemory::Tag::tag_count; ++i ) {
+          Auto tag = tags [ i ];
+
+          if ( !m_game_memory.tag_high_water ( tag ) ) {
+               continue;
+          }
+
+          LOG_INFO ( "  %-12s %10u used %10u high water\n", GameMemory::tag_name ( tag ),
+                     m_game_memory.tag_used ( tag ), m_game_memory.tag_high_water ( tag ) );
+     }
+}
+
+Void Simulation::render ( SDL_Surface* back_buffer, Real32 interpolation )
+{
+     m_game_memory.reset ( GameMemory::Arena::frame );
+
+     m_game_functions.game_render_func ( m_game_memory, back_buffer, interpolation );
+}
+
+Bool Simulation::load_snapshot ( const Char8* path, Void* game_settings )
+{
+     // the snapshot replaces the pointers to everything game_init loaded, free it while they're known
+     destroy ( );
+
+     if ( !load_game_memory ( path ) ) {
+          return false;
+     }
+
+     // resources outside of game memory were owned by the run that took the snapshot
+     if ( !m_game_functions.game_restore_func ( m_game_memory, game_settings ) ) {
+          return false;
+     }
+
+     m_game_initialized = true;
+
+     return true;
+}
+
+Bool Simulation::start_recording ( )
+{
+     if ( m_input_recorder.is_recording ( ) || m_input_recorder.is_playing_back ( ) ) {
+          return false;
+     }
+
+     if ( !m_input_recorder.start_recording ( c_record_input_filepath ) ) {
+          return false;
+     }
+
+     // frames count from the start of the recording so they can be sought in playback
+     m_frame = 0;
+     m_snapshot_ring.clear ( );
+
+     return save_game_memory ( c_game_memory_filepath );
+}
+
+Bool Simulation::start_playing_back ( )
+{
+     if ( !m_input_recorder.is_recording ( ) ) {
+          return false;
+     }
+
+     m_input_recorder.stop_recording ( );
+
+     if ( !load_game_memory ( c_game_memory_filepath ) || !resume_game ( ) ) {
+          return false;
+     }
+
+     m_frame = 0;
+     m_snapshot_ring.clear ( );
+
+     return m_input_recorder.start_playing_back ( c_record_input_filepath );
+}
+
+Bool Simulation::stop_playing_back ( )
+{
+     if ( !m_input_recorder.is_playing_back ( ) ) {
+          return false;
+     }
+
+     return m_input_recorder.stop_playing_back ( );
+}
+
+Bool Simulation::seek ( Uint64 frame )
+{
+     Uint64 restored_frame = 0;
+     Uint64 input_position = 0;
+
+     if ( !m_snapshot_ring.restore ( m_game_memory, frame, &restored_frame, &input_position ) ) {
+          LOG_WARNING ( "No snapshot at or before frame %llu to seek to.\n",
+                        static_cast<unsigned long long>( frame ) );
+          return false;
+     }
+
+     if ( !resume_game ( ) ) {
+          return false;
+     }
+
+     LOG_INFO ( "Restored snapshot of frame %llu\n", static_cast<unsigned long long>( restored_frame ) );
+
+     m_frame = restored_frame;
+
+     if ( m_input_recorder.is_recording ( ) || m_input_recorder.is_playing_back ( ) ) {
+          if ( !m_input_recorder.seek ( input_position ) ) {
+               return false;
+          }
+     }
+
+     if ( !m_input_recorder.is_playing_back ( ) ) {
+          // whatever happens next replaces the frames after this one
+          m_snapshot_ring.discard_after ( restored_frame );
+          return true;
+     }
+
+     // replay the recorded input up to the frame, stopping if the recording runs out first
+     Uint32 loop_count = m_playback_loop_count;
+
+     while ( m_frame < frame && loop_count == m_playback_loop_count ) {
+          GameInput game_input;
+
+          update ( game_input, m_last_time_delta );
+     }
+
+     return true;
+}
+
+Bool Simulation::rewind ( Uint32 frame_count )
+{
+     return seek ( m_frame > frame_count ? m_frame - frame_count : 0 );
+}
+
+Bool Simulation::resume_game ( )
+{
+     // the game may have freed things since the snapshot was taken, it re-resolves them
+     if ( !m_game_functions.game_resume_func ( m_game_memory ) ) {
+          LOG_ERROR ( "Game failed to resume from restored game memory.\n" );
+          return false;
+     }
+
+     return true;
+}
+
+Void Simulation::set_snapshots_enabled ( Bool enabled )
+{
+     m_snapshots_enabled = enabled;
+
+     if ( !enabled ) {
+          m_snapshot_ring.clear ( );
+     }
+}
+
+Void Simulation::take_snapshot ( )
+{
+     if ( !m_snapshots_enabled ) {
+          return;
+     }
+
+     Uint64 input_position = m_input_recorder.position ( );
+
+     m_snapshot_ring.push ( m_game_memory, m_frame, input_position );
+}
+
+Bool Simulation::allocate_game_memory ( Uint32 size )
+{
+     free_game_memory ( );
+
+     LOG_INFO ( "Allocating game memory: %d bytes\n", size );
+
+#ifdef LINUX
+     Void* base_address = reinterpret_cast<Void*>( c_game_memory_base_address );
+     Void* memory = mmap ( base_address, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+     if ( memory == MAP_FAILED ) {
+          LOG_ERROR ( "Allocation of %u bytes failed, mmap() failed.\n", size );
+          return false;
+     }
+
+     if ( memory != base_address ) {
+          LOG_WARNING ( "Game memory could not be placed at 0x%llx, snapshots from other runs won't load.\n",
+                        static_cast<unsigned long long>( c_game_memory_base_address ) );
+     }
+#else
+     Void* memory = calloc ( size, 1 );
+
+     if ( !memory ) {
+          LOG_ERROR ( "Allocation of %u bytes failed, calloc() returned NULL.\n", size );
+          return false;
+     }
+#endif
+
+     m_game_memory = GameMemory ( memory, size );
+
+     return true;
+}
+
+Void Simulation::free_game_memory ( )
+{
+     if ( m_game_memory.location ( ) ) {
+          LOG_INFO ( "Freeing allocated game memory.\n" );
+#ifdef LINUX
+          munmap ( m_game_memory.location ( ), m_game_memory.size ( ) );
+#else
+          free ( m_game_memory.location ( ) );
+#endif
+          m_game_memory.clear ( );
+     }
+}
+
+static Bool validate_snapshot_header ( const SnapshotHeader& header, const Char8* path, GameMemory& game_memory )
+{
+     if ( header.magic != c_snapshot_magic ) {
+          LOG_ERROR ( "'%s' is not a game memory snapshot.\n", path );
+          return false;
+     }
+
+     if ( header.size != game_memory.size ( ) ||
+          header.base_address != reinterpret_cast<Uint64>( game_memory.location ( ) ) ) {
+          LOG_ERROR ( "Snapshot '%s' was taken of %u bytes at 0x%llx, game memory is %u bytes at 0x%llx.\n",
+                      path, header.size, static_cast<unsigned long long>( header.base_address ),
+                      game_memory.size ( ),
+                      static_cast<unsigned long long>( reinterpret_cast<Uint64>( game_memory.location ( ) ) ) );
+          return false;
+     }
+
+     if ( header.used > header.size ) {
+          LOG_ERROR ( "Snapshot '%s' claims %u bytes used of %u.\n", path, header.used, header.size );
+          return false;
+     }
+
+     return true;
+}
+
+static Void build_snapshot_header ( SnapshotHeader& header, GameMemory& game_memory )
+{
+     header.magic        = c_snapshot_magic;
+     header.size         = game_memory.size ( );
+     header.used         = game_memory.used ( );
+     header.reserved     = 0;
+     header.base_address = reinterpret_cast<Uint64>( game_memory.location ( ) );
+}
+
+#ifdef LINUX
+
+Bool Simulation::map_snapshot ( const Char8* path, Uint32 size )
+{
+     unmap_snapshot ( );
+
+     Bool writable = size > 0;
+
+     m_snapshot_file = open ( path, writable ? ( O_RDWR | O_CREAT ) : O_RDONLY, 0644 );
+
+     if ( m_snapshot_file < 0 ) {
+          LOG_ERROR ( "Failed to open snapshot '%s'.\n", path );
+          return false;
+     }
+
+     if ( writable ) {
+          if ( ftruncate ( m_snapshot_file, size ) ) {
+               LOG_ERROR ( "Failed to size snapshot '%s' to %u bytes.\n", path, size );
+               unmap_snapshot ( );
+               return false;
+          }
+     } else {
+          struct stat file_stat;
+
+          if ( fstat ( m_snapshot_file, &file_stat ) || file_stat.st_size < static_cast<off_t>( sizeof ( SnapshotHeader ) ) ) {
+               LOG_ERROR ( "'%s' is too small to be a game memory snapshot.\n", path );
+               unmap_snapshot ( );
+               return false;
+          }
+
+          size = static_cast<Uint32>( file_stat.st_size );
+     }
+
+     Void* memory = mmap ( nullptr, size, writable ? ( PROT_READ | PROT_WRITE ) : PROT_READ,
+                           MAP_SHARED, m_snapshot_file, 0 );
+
+     if ( memory == MAP_FAILED ) {
+          LOG_ERROR ( "Failed to map snapshot '%s', mmap() failed.\n", path );
+          unmap_snapshot ( );
+          return false;
+     }
+
+     m_snapshot          = memory;
+     m_snapshot_size     = size;
+     m_snapshot_writable = writable;
+
+     strncpy ( m_snapshot_path, path, c_max_snapshot_path_length - 1 );
+     m_snapshot_path [ c_max_snapshot_path_length - 1 ] = '\0';
+
+     return true;
+}
+
+Void Simulation::unmap_snapshot ( )
+{
+     if ( m_snapshot ) {
+          munmap ( m_snapshot, m_snapshot_size );
+     }
+
+     if ( m_snapshot_file >= 0 ) {
+          close ( m_snapshot_file );
+     }
+
+     m_snapshot_file       = -1;
+     m_snapshot            = nullptr;
+     m_snapshot_size       = 0;
+     m_snapshot_writable   = false;
+     m_snapshot_path [ 0 ] = '\0';
+}
+
+Bool Simulation::save_game_memory ( const Char8* path )
+{
+     Uint32 snapshot_size = sizeof ( SnapshotHeader ) + m_game_memory.used ( );
+
+     LOG_INFO ( "Saving %u bytes of game memory to '%s'\n", m_game_memory.used ( ), path );
+
+     // the kernel writes the dirty pages back to the file, we only pay for the copy
+     if ( !m_snapshot_writable || m_snapshot_size != snapshot_size || strcmp ( m_snapshot_path, path ) ) {
+          if ( !map_snapshot ( path, snapshot_size ) ) {
+               return false;
+          }
+     }
+
+     Auto* header = reinterpret_cast<SnapshotHeader*>( m_snapshot );
+
+     build_snapshot_header ( *header, m_game_memory );
+
+     memcpy ( header + 1, m_game_memory.location ( ), m_game_memory.used ( ) );
+
+     return true;
+}
+
+Bool Simulation::load_game_memory ( const Char8* path )
+{
+     LOG_INFO ( "Loading game memory from '%s'\n", path );
+
+     if ( !m_snapshot || strcmp ( m_snapshot_path, path ) ) {
+          if ( !map_snapshot ( path, 0 ) ) {
+               return false;
+          }
+     }
+
+     Auto* header = reinterpret_cast<const SnapshotHeader*>( m_snapshot );
+
+     if ( !validate_snapshot_header ( *header, path, m_game_memory ) ) {
+          return false;
+     }
+
+     if ( m_snapshot_size < sizeof ( SnapshotHeader ) + header->used ) {
+          LOG_ERROR ( "Snapshot '%s' is truncated, expected %u bytes of game memory.\n", path, header->used );
+          return false;
+     }
+
+     memcpy ( m_game_memory.location ( ), header + 1, header->used );
+
+     return true;
+}
+
+#else
+
+Bool Simulation::map_snapshot ( const Char8* path, Uint32 size )
+{
+     return false;
+}
+
+Void Simulation::unmap_snapshot ( )
+{
+
+}
+
+Bool Simulation::save_game_memory ( const Char8* path )
+{
+     LOG_INFO ( "Saving %u bytes of game memory to '%s'\n", m_game_memory.used ( ), path );
+
+     std::ofstream file ( path, std::ios::binary );
+
+     if ( !file.is_open ( ) ) {
+          LOG_ERROR ( "Failed to open '%s' to save game memory.\n", path );
+          return false;
+     }
+
+     SnapshotHeader header;
+
+     build_snapshot_header ( header, m_game_memory );
+
+     file.write ( reinterpret_cast<Char8*>( &header ), sizeof ( header ) );
+     file.write ( reinterpret_cast<Char8*>( m_game_memory.location ( ) ), m_game_memory.used ( ) );
+
+     if ( !file ) {
+          LOG_ERROR ( "Failed to write %u bytes to '%s' to save game memory.\n",
+                      m_game_memory.used ( ), path );
+          return false;
+     }
+
+     return true;
+}
+
+Bool Simulation::load_game_memory ( const Char8* path )
+{
+     LOG_INFO ( "Loading game memory from '%s'\n", path );
+
+     std::ifstream file ( path, std::ios::binary );
+
+     if ( !file.is_open ( ) ) {
+          LOG_ERROR ( "Failed to open '%s' to load game memory.\n", path );
+          return false;
+     }
+
+     SnapshotHeader header;
+
+     file.read ( reinterpret_cast<Char8*>( &header ), sizeof ( header ) );
+
+     if ( !file || !validate_snapshot_header ( header, path, m_game_memory ) ) {
+          return false;
+     }
+
+     file.read ( reinterpret_cast<Char8*>( m_game_memory.location ( ) ), header.used );
+
+     if ( !file ) {
+          LOG_ERROR ( "Failed to read %u bytes from '%s' to load game memory.\n", header.used, path );
+          return false;
+     }
+
+     return true;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include "InputRecorder.hpp"
+#include "GameMemory.hpp"
+#include "GameFunction.hpp"
+#include "SnapshotRing.hpp"
+
+#include <SDL2/SDL.h>
+
+// Owns the loaded game code and its memory and steps it, knows nothing about windows so it
+// can be driven by the application or headless
+class Simulation {
+public:
+
+     Simulation ( );
+     ~Simulation ( );
+
+     Bool load ( const Char8* shared_library_path, Uint32 game_memory_allocation_size,
+                 Uint32 game_memory_warning_threshold, Void* game_settings );
+     Void destroy ( );
+
+     Bool reload_game_code ( );
+
+     // hand input to the game and advance it a step, records or replaces the input when
+     // recording or playing back
+     Void update ( GameInput& game_input, Real32 time_delta );
+     Void render ( SDL_Surface* back_buffer, Real32 interpolation );
+
+     // log how full each arena is and has been, and what each tag holds
+     Void log_memory_usage ( );
+
+     Bool save_game_memory ( const Char8* path );
+     Bool load_game_memory ( const Char8* path );
+
+     // load a snapshot that may have been saved by another run and have the game restore itself
+     Bool load_snapshot ( const Char8* path, Void* game_settings );
+
+     Bool start_recording ( );
+     Bool start_playing_back ( );
+     Bool stop_playing_back ( );
+
+     // jump back to the newest snapshot at or before a frame, when playing back the game is then
+     // stepped forward to land exactly on it
+     Bool seek ( Uint64 frame );
+     Bool rewind ( Uint32 frame_count );
+
+     // on by default, benchmarks and headless runs turn snapshots off so update ( ) only
+     // times the game
+     Void set_snapshots_enabled ( Bool enabled );
+
+     inline Uint64 frame ( ) const;
+
+     inline InputRecorder& input_recorder ( );
+     inline GameMemory& game_memory ( );
+     inline SnapshotRing& snapshot_ring ( );
+
+public:
+
+     static const Char8* c_game_memory_filepath;
+     static const Char8* c_record_input_filepath;
+
+     // half a second at 30 frames per second
+     static const Uint32 c_snapshot_frame_interval = 15;
+
+private:
+
+     Void take_snapshot ( );
+
+     // after memory this run saved is copied back in, so the game can fix up what lives outside it
+     Bool resume_game ( );
+
+     Bool allocate_game_memory ( Uint32 size );
+     Void free_game_memory ( );
+
+     // map a snapshot file, creating or resizing it when a size is given, the mapping is kept
+     // so saving and looping the same snapshot again is only a copy
+     Bool map_snapshot ( const Char8* path, Uint32 size );
+     Void unmap_snapshot ( );
+
+private:
+
+     static const Uint32 c_max_snapshot_path_length = 256;
+
+     GameFunctions m_game_functions;
+     GameMemory    m_game_memory;
+
+     InputRecorder m_input_recorder;
+     SnapshotRing  m_snapshot_ring;
+
+     Uint64        m_frame;
+     Uint32        m_playback_loop_count;
+     Real32        m_last_time_delta;
+     Bool          m_snapshots_enabled;
+
+     const Char8*  m_shared_library_path;
+     Bool          m_game_initialized;
+
+     Int32         m_snapshot_file;
+     Void*         m_snapshot;
+     Uint32        m_snapshot_size;
+     Bool          m_snapshot_writable;
+     Char8         m_snapshot_path [ c_max_snapshot_path_length ];
+};
+
+inline Uint64 Simulation::frame ( ) const
+{
+     return m_frame;
+}
+
+inline InputRecorder& Simulation::input_recorder ( )
+{
+     return m_input_recorder;
+}
+
+inline GameMemory& Simulation::game_memory ( )
+{
+     return m_game_memory;
+}
+
+inline SnapshotRing& Simulation::snapshot_ring ( )
+{
+     return m_snapshot_ring;
+}
+
+#endif
+
@@ -0,0 +1,354 @@
+#include "SnapshotRing.hpp"
+#include "GameMemory.hpp"
+#include "Log.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+// a delta is a list of runs over 8 byte words: how many words match the keyframe, how many
+// follow that don't, then those words. The few bytes past the last whole word trail it raw.
+struct DeltaRun {
+     Uint32 skip_words;
+     Uint32 copy_words;
+};
+
+static inline Uint64 load_word ( const Uint8* bytes, Uint32 word )
+{
+     Uint64 value;
+     memcpy ( &value, bytes + word * sizeof ( Uint64 ), sizeof ( value ) );
+     return value;
+}
+
+SnapshotRing::SnapshotRing ( ) :
+     m_snapshots         ( nullptr ),
+     m_capacity          ( 0 ),
+     m_keyframe_interval ( 0 ),
+     m_oldest            ( 0 ),
+     m_count             ( 0 )
+{
+
+}
+
+SnapshotRing::~SnapshotRing ( )
+{
+     free_snapshots ( );
+}
+
+Bool SnapshotRing::start ( Uint32 capacity, Uint32 keyframe_interval )
+{
+     free_snapshots ( );
+
+     if ( !capacity || !keyframe_interval ) {
+          LOG_ERROR ( "Snapshot ring needs a capacity and keyframe interval, got %u and %u\n",
+                      capacity, keyframe_interval );
+          return false;
+     }
+
+     m_snapshots = reinterpret_cast<Snapshot*>( calloc ( capacity, sizeof ( Snapshot ) ) );
+
+     if ( !m_snapshots ) {
+          LOG_ERROR ( "Failed to allocate snapshot ring of %u snapshots\n", capacity );
+          return false;
+     }
+
+     m_capacity          = capacity;
+     m_keyframe_interval = keyframe_interval;
+
+     clear ( );
+
+     return true;
+}
+
+Void SnapshotRing::clear ( )
+{
+     m_oldest = 0;
+     m_count  = 0;
+}
+
+Bool SnapshotRing::push ( GameMemory& game_memory, Uint64 frame, Uint64 input_position )
+{
+     if ( !m_capacity ) {
+          return false;
+     }
+
+     if ( m_count && frame <= newest_frame ( ) ) {
+          return false;
+     }
+
+     if ( m_count == m_capacity ) {
+          pop_oldest ( );
+     }
+
+     Uint32 keyframe_slot = 0;
+     Uint32 since_keyframe = m_count;
+
+     // walk back from the newest snapshot to the keyframe it was built against
+     if ( m_count ) {
+          const Snapshot& newest = m_snapshots [ slot ( m_count - 1 ) ];
+
+          keyframe_slot = newest.keyframe_slot;
+          since_keyframe = ( newest.keyframe_slot <= slot ( m_count - 1 ) ) ?
+                           slot ( m_count - 1 ) - newest.keyframe_slot :
+                           slot ( m_count - 1 ) + m_capacity - newest.keyframe_slot;
+          since_keyframe++;
+     }
+
+     Snapshot& snapshot = m_snapshots [ slot ( m_count ) ];
+
+     snapshot.frame          = frame;
+     snapshot.input_position = input_position;
+     snapshot.used           = game_memory.used ( );
+
+     Bool stored = false;
+
+     if ( m_count && since_keyframe < m_keyframe_interval ) {
+          stored = store_delta ( snapshot, m_snapshots [ keyframe_slot ], game_memory );
+          snapshot.keyframe_slot = keyframe_slot;
+     }
+
+     // deltas that don't pay for themselves become keyframes
+     if ( !stored ) {
+          if ( !store_keyframe ( snapshot, game_memory ) ) {
+               return false;
+          }
+
+          snapshot.keyframe_slot = slot ( m_count );
+     }
+
+     m_count++;
+
+     return true;
+}
+
+Bool SnapshotRing::restore ( GameMemory& game_memory, Uint64 frame, Uint64* restored_frame,
+                             Uint64* restored_input_position ) const
+{
+     const Snapshot* found = nullptr;
+
+     for ( Uint32 i = m_count; i > 0; --i ) {
+          const Snapshot& snapshot = m_snapshots [ slot ( i - 1 ) ];
+
+          if ( snapshot.frame <= frame ) {
+               found = &snapshot;
+               break;
+          }
+     }
+
+     if ( !found ) {
+          return false;
+     }
+
+     const Snapshot& keyframe = m_snapshots [ found->keyframe_slot ];
+     Uint8* memory = reinterpret_cast<Uint8*>( game_memory.location ( ) );
+
+     memcpy ( memory, keyframe.data, keyframe.used );
+
+     if ( !found->keyframe ) {
+          // the delta was taken against zeros past the keyframe's last whole word
+          Uint32 keyframe_words_size = ( keyframe.used / sizeof ( Uint64 ) ) * sizeof ( Uint64 );
+
+          if ( found->used > keyframe_words_size ) {
+               memset ( memory + keyframe_words_size, 0, found->used - keyframe_words_size );
+          }
+
+          Uint32 word_count = found->used / sizeof ( Uint64 );
+          Uint32 tail_size = found->used % sizeof ( Uint64 );
+          const Uint8* delta = found->data;
+          const Uint8* delta_end = found->data + found->data_size - tail_size;
+          Uint32 word = 0;
+
+          while ( delta < delta_end ) {
+               DeltaRun run;
+
+               memcpy ( &run, delta, sizeof ( run ) );
+               delta += sizeof ( run );
+
+               word += run.skip_words;
+
+               memcpy ( memory + word * sizeof ( Uint64 ), delta, run.copy_words * sizeof ( Uint64 ) );
+
+               delta += run.copy_words * sizeof ( Uint64 );
+               word  += run.copy_words;
+          }
+
+          memcpy ( memory + word_count * sizeof ( Uint64 ), delta_end, tail_size );
+     }
+
+     *restored_frame          = found->frame;
+     *restored_input_position = found->input_position;
+
+     return true;
+}
+
+Void SnapshotRing::discard_after ( Uint64 frame )
+{
+     while ( m_count && m_snapshots [ slot ( m_count - 1 ) ].frame > frame ) {
+          m_count--;
+     }
+}
+
+Uint64 SnapshotRing::newest_frame ( ) const
+{
+     return m_count ? m_snapshots [ slot ( m_count - 1 ) ].frame : 0;
+}
+
+Uint64 SnapshotRing::oldest_frame ( ) const
+{
+     return m_count ? m_snapshots [ m_oldest ].frame : 0;
+}
+
+Uint64 SnapshotRing::bytes_stored ( ) const
+{
+     Uint64 total = 0;
+
+     for ( Uint32 i = 0; i < m_count; ++i ) {
+          total += m_snapshots [ slot ( i ) ].data_size;
+     }
+
+     return total;
+}
+
+Void SnapshotRing::log_statistics ( ) const
+{
+     Uint32 keyframes = 0;
+
+     for ( Uint32 i = 0; i < m_count; ++i ) {
+          if ( m_snapshots [ slot ( i ) ].keyframe ) {
+               keyframes++;
+          }
+     }
+
+     LOG_INFO ( "Snapshot ring: %u snapshots (%u keyframes) covering frames %llu to %llu in %.2f MB\n",
+                m_count, keyframes,
+                static_cast<unsigned long long>( oldest_frame ( ) ),
+                static_cast<unsigned long long>( newest_frame ( ) ),
+                static_cast<Real64>( bytes_stored ( ) ) / ( 1024.0 * 1024.0 ) );
+}
+
+Bool SnapshotRing::reserve ( Snapshot& snapshot, Uint32 size )
+{
+     if ( size <= snapshot.data_capacity ) {
+          return true;
+     }
+
+     Uint32 capacity = snapshot.data_capacity ? snapshot.data_capacity : 4096;
+
+     while ( capacity < size ) {
+          capacity *= 2;
+     }
+
+     Uint8* data = reinterpret_cast<Uint8*>( realloc ( snapshot.data, capacity ) );
+
+     if ( !data ) {
+          LOG_ERROR ( "Failed to allocate %u bytes for a game memory snapshot\n", capacity );
+          return false;
+     }
+
+     snapshot.data          = data;
+     snapshot.data_capacity = capacity;
+
+     return true;
+}
+
+Void SnapshotRing::pop_oldest ( )
+{
+     // deltas can't outlive their keyframe, drop them along with it
+     do {
+          m_oldest = ( m_oldest + 1 ) % m_capacity;
+          m_count--;
+     } while ( m_count && !m_snapshots [ m_oldest ].keyframe );
+}
+
+Bool SnapshotRing::store_keyframe ( Snapshot& snapshot, GameMemory& game_memory )
+{
+     if ( !reserve ( snapshot, snapshot.used ) ) {
+          return false;
+     }
+
+     memcpy ( snapshot.data, game_memory.location ( ), snapshot.used );
+
+     snapshot.data_size = snapshot.used;
+     snapshot.keyframe  = true;
+
+     return true;
+}
+
+Bool SnapshotRing::store_delta ( Snapshot& snapshot, const Snapshot& keyframe, GameMemory& game_memory )
+{
+     const Uint8* memory = reinterpret_cast<const Uint8*>( game_memory.location ( ) );
+
+     Uint32 word_count = snapshot.used / sizeof ( Uint64 );
+     Uint32 keyframe_word_count = keyframe.used / sizeof ( Uint64 );
+     Uint32 tail_size = snapshot.used % sizeof ( Uint64 );
+
+     // past half the size of a keyframe it is cheaper to restore from a keyframe
+     Uint32 max_size = snapshot.used / 2;
+     Uint32 size = 0;
+     Uint32 word = 0;
+
+     while ( word < word_count ) {
+          DeltaRun run { 0, 0 };
+
+          while ( word < word_count &&
+                  load_word ( memory, word ) == ( word < keyframe_word_count ? load_word ( keyframe.data, word ) : 0 ) ) {
+               run.skip_words++;
+               word++;
+          }
+
+          if ( word == word_count ) {
+               break;
+          }
+
+          Uint32 first_copy_word = word;
+
+          while ( word < word_count &&
+                  load_word ( memory, word ) != ( word < keyframe_word_count ? load_word ( keyframe.data, word ) : 0 ) ) {
+               run.copy_words++;
+               word++;
+          }
+
+          Uint32 run_size = sizeof ( run ) + run.copy_words * sizeof ( Uint64 );
+
+          if ( size + run_size + tail_size > max_size ) {
+               return false;
+          }
+
+          if ( !reserve ( snapshot, size + run_size ) ) {
+               return false;
+          }
+
+          memcpy ( snapshot.data + size, &run, sizeof ( run ) );
+          memcpy ( snapshot.data + size + sizeof ( run ), memory + first_copy_word * sizeof ( Uint64 ),
+                   run.copy_words * sizeof ( Uint64 ) );
+
+          size += run_size;
+     }
+
+     if ( !reserve ( snapshot, size + tail_size ) ) {
+          return false;
+     }
+
+     memcpy ( snapshot.data + size, memory + word_count * sizeof ( Uint64 ), tail_size );
+
+     snapshot.data_size = size + tail_size;
+     snapshot.keyframe  = false;
+
+     return true;
+}
+
+Void SnapshotRing::free_snapshots ( )
+{
+     if ( m_snapshots ) {
+          for ( Uint32 i = 0; i < m_capacity; ++i ) {
+               free ( m_snapshots [ i ].data );
+          }
+
+          free ( m_snapshots );
+     }
+
+     m_snapshots = nullptr;
+     m_capacity  = 0;
+     m_count     = 0;
+     m_oldest    = 0;
+}
+
@@ -0,0 +1,93 @@
+#ifndef SNAPSHOT_RING_HPP
+#define SNAPSHOT_RING_HPP
+
+#include "Types.hpp"
+
+class GameMemory;
+
+// Keeps the last few seconds of game memory, every few snapshots is a full keyframe and the
+// ones between only store the words that changed since that keyframe
+class SnapshotRing {
+public:
+
+     SnapshotRing ( );
+     ~SnapshotRing ( );
+
+     Bool start ( Uint32 capacity, Uint32 keyframe_interval );
+     Void clear ( );
+
+     // snapshot game memory as it is at the start of a frame, frames must only increase
+     Bool push ( GameMemory& game_memory, Uint64 frame, Uint64 input_position );
+
+     // copy the newest snapshot at or before frame back into game memory
+     Bool restore ( GameMemory& game_memory, Uint64 frame, Uint64* restored_frame,
+                    Uint64* restored_input_position ) const;
+
+     // forget snapshots after a frame, used when the game diverges from what was recorded
+     Void discard_after ( Uint64 frame );
+
+     inline Uint32 count ( ) const;
+     inline Bool empty ( ) const;
+     Uint64 newest_frame ( ) const;
+     Uint64 oldest_frame ( ) const;
+
+     Uint64 bytes_stored ( ) const;
+
+     Void log_statistics ( ) const;
+
+public:
+
+     static const Uint32 c_default_capacity = 64;
+     static const Uint32 c_default_keyframe_interval = 8;
+
+private:
+
+     struct Snapshot {
+          Uint64 frame;
+          Uint64 input_position;
+          Uint32 used;
+          Uint32 keyframe_slot;
+          Bool   keyframe;
+
+          Uint8* data;
+          Uint32 data_size;
+          Uint32 data_capacity;
+     };
+
+     inline Uint32 slot ( Uint32 index ) const;
+
+     Bool reserve ( Snapshot& snapshot, Uint32 size );
+     Void pop_oldest ( );
+
+     Bool store_keyframe ( Snapshot& snapshot, GameMemory& game_memory );
+     Bool store_delta ( Snapshot& snapshot, const Snapshot& keyframe, GameMemory& game_memory );
+
+     Void free_snapshots ( );
+
+private:
+
+     Snapshot* m_snapshots;
+     Uint32    m_capacity;
+     Uint32    m_keyframe_interval;
+
+     Uint32    m_oldest;
+     Uint32    m_count;
+};
+
+inline Uint32 SnapshotRing::count ( ) const
+{
+     return m_count;
+}
+
+inline Bool SnapshotRing::empty ( ) const
+{
+     return m_count == 0;
+}
+
+inline Uint32 SnapshotRing::slot ( Uint32 index ) const
+{
+     return ( m_oldest + index ) % m_capacity;
+}
+
+#endif
+
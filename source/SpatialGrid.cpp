@@ -0,0 +1,129 @@
+#include "SpatialGrid.hpp"
+
+using namespace bryte;
+
+Bool SpatialGrid::allocate ( GameMemory& game_memory, Uint32 capacity )
+{
+     word_count = word_count_for ( capacity );
+
+     Uint32 max_nodes = capacity * c_nodes_per_item;
+
+     oversized = game_memory.push_array<Uint64> ( word_count, GameMemory::Arena::permanent, GameMemory::Tag::spatial_grid );
+     marked = game_memory.push_array<Uint64> ( word_count, GameMemory::Arena::permanent, GameMemory::Tag::spatial_grid );
+     node_next = game_memory.push_array<Int32> ( max_nodes, GameMemory::Arena::permanent, GameMemory::Tag::spatial_grid );
+     node_items = game_memory.push_array<Uint32> ( max_nodes, GameMemory::Arena::permanent, GameMemory::Tag::spatial_grid );
+     found_indices = game_memory.push_array<Uint32> ( capacity, GameMemory::Arena::permanent, GameMemory::Tag::spatial_grid );
+
+     if ( !oversized || !marked || !node_next || !node_items || !found_indices ) {
+          return false;
+     }
+
+     this->capacity = capacity;
+
+     width = 0;
+     height = 0;
+     node_count = 0;
+
+     return true;
+}
+
+Void SpatialGrid::clear ( Int32 width, Int32 height )
+{
+     ASSERT ( width * height <= static_cast<Int32>( c_max_cells ) );
+
+     this->width = width;
+     this->height = height;
+
+     for ( Int32 i = 0; i < width * height; ++i ) {
+          cell_heads [ i ] = -1;
+     }
+
+     for ( Uint32 i = 0; i < word_count; ++i ) {
+          oversized [ i ] = 0;
+     }
+
+     node_count = 0;
+}
+
+Void SpatialGrid::insert ( Uint32 index, Real32 x, Real32 y, Real32 width, Real32 height )
+{
+     ASSERT ( index < capacity );
+
+     if ( this->width <= 0 || this->height <= 0 ) {
+          return;
+     }
+
+     Int32 min_x, min_y, max_x, max_y;
+
+     cell_range ( x, y, width, height, 0, &min_x, &min_y, &max_x, &max_y );
+
+     Uint32 cell_count = ( max_x - min_x + 1 ) * ( max_y - min_y + 1 );
+
+     if ( node_count + cell_count > capacity * c_nodes_per_item ) {
+          oversized [ index / 64 ] |= 1ull << ( index % 64 );
+          return;
+     }
+
+     for ( Int32 cy = min_y; cy <= max_y; ++cy ) {
+          for ( Int32 cx = min_x; cx <= max_x; ++cx ) {
+               Int32 cell = cy * this->width + cx;
+
+               node_items [ node_count ] = index;
+               node_next [ node_count ] = cell_heads [ cell ];
+               cell_heads [ cell ] = node_count;
+               node_count++;
+          }
+     }
+}
+
+Void SpatialGrid::query ( Real32 x, Real32 y, Real32 width, Real32 height, Found& found ) const
+{
+     for ( Uint32 i = 0; i < word_count; ++i ) {
+          marked [ i ] = oversized [ i ];
+     }
+
+     found.indices = found_indices;
+     found.count = 0;
+
+     if ( this->width <= 0 || this->height <= 0 ) {
+          return;
+     }
+
+     Int32 min_x, min_y, max_x, max_y;
+
+     cell_range ( x, y, width, height, c_padding_cells, &min_x, &min_y, &max_x, &max_y );
+
+     for ( Int32 cy = min_y; cy <= max_y; ++cy ) {
+          for ( Int32 cx = min_x; cx <= max_x; ++cx ) {
+               for ( Int32 node = cell_heads [ cy * this->width + cx ]; node >= 0; node = node_next [ node ] ) {
+                    marked [ node_items [ node ] / 64 ] |= 1ull << ( node_items [ node ] % 64 );
+               }
+          }
+     }
+
+     for ( Uint32 w = 0; w < word_count; ++w ) {
+          if ( !marked [ w ] ) {
+               continue;
+          }
+
+          for ( Uint32 b = 0; b < 64; ++b ) {
+               if ( marked [ w ] & ( 1ull << b ) ) {
+                    found_indices [ found.count++ ] = w * 64 + b;
+               }
+          }
+     }
+}
+
+inline Void SpatialGrid::cell_range ( Real32 x, Real32 y, Real32 width, Real32 height, Int32 padding,
+                                      Int32* min_x, Int32* min_y, Int32* max_x, Int32* max_y ) const
+{
+     *min_x = meters_to_pixels ( x ) / Map::c_tile_dimension_in_pixels - padding;
+     *min_y = meters_to_pixels ( y ) / Map::c_tile_dimension_in_pixels - padding;
+     *max_x = meters_to_pixels ( x + width ) / Map::c_tile_dimension_in_pixels + padding;
+     *max_y = meters_to_pixels ( y + height ) / Map::c_tile_dimension_in_pixels + padding;
+
+     CLAMP ( *min_x, 0, this->width - 1 );
+     CLAMP ( *min_y, 0, this->height - 1 );
+     CLAMP ( *max_x, 0, this->width - 1 );
+     CLAMP ( *max_y, 0, this->height - 1 );
+}
@@ -0,0 +1,80 @@
+#ifndef BRYTE_SPATIAL_GRID_HPP
+#define BRYTE_SPATIAL_GRID_HPP
+
+#include "Map.hpp"
+#include "GameMemory.hpp"
+#include "Utils.hpp"
+
+namespace bryte
+{
+     // buckets up to capacity items by the map tiles their bounds touch. Items are indices into whatever
+     // the caller inserted, queries report them in ascending order so anything that stops at the
+     // first hit behaves the same as a loop over every item would.
+     // Items may move up to a tile after they are inserted, queries look one tile past their area
+     struct SpatialGrid {
+
+          // indices point into the grid, the next query overwrites them
+          struct Found {
+               const Uint32* indices;
+               Uint32 count;
+          };
+
+          // takes the nodes and scratch from the permanent arena, only once before the first clear ( )
+          Bool allocate ( GameMemory& game_memory, Uint32 capacity );
+
+          // bytes allocate ( ) pushes for a capacity
+          static inline Uint32 bytes_for ( Uint32 capacity );
+
+          Void clear ( Int32 width, Int32 height );
+
+          Void insert ( Uint32 index, Real32 x, Real32 y, Real32 width, Real32 height );
+
+          // candidates whose bounds are near the area, they still need an exact test
+          Void query ( Real32 x, Real32 y, Real32 width, Real32 height, Found& found ) const;
+
+          static const Uint32 c_max_cells = Map::c_max_tiles;
+          static const Uint32 c_nodes_per_item = 4;
+          static const Int32  c_padding_cells = 1;
+
+          Int32  width;
+          Int32  height;
+
+          Uint32 capacity;
+          Uint32 word_count;
+
+          // each cell is a linked list of nodes, -1 ends it
+          Int32  cell_heads [ c_max_cells ];
+          Int32* node_next;
+          Uint32* node_items;
+          Uint32 node_count;
+
+          // items too big for the nodes left over are reported by every query
+          Uint64* oversized;
+
+          // query scratch
+          Uint64* marked;
+          Uint32* found_indices;
+
+     private:
+
+          static inline Uint32 word_count_for ( Uint32 capacity );
+
+          inline Void cell_range ( Real32 x, Real32 y, Real32 width, Real32 height, Int32 padding,
+                                   Int32* min_x, Int32* min_y, Int32* max_x, Int32* max_y ) const;
+     };
+
+     inline Uint32 SpatialGrid::bytes_for ( Uint32 capacity )
+     {
+          return GameMemory::array_bytes<Uint64> ( word_count_for ( capacity ) ) * 2 +
+                 GameMemory::array_bytes<Int32> ( capacity * c_nodes_per_item ) +
+                 GameMemory::array_bytes<Uint32> ( capacity * c_nodes_per_item ) +
+                 GameMemory::array_bytes<Uint32> ( capacity );
+     }
+
+     inline Uint32 SpatialGrid::word_count_for ( Uint32 capacity )
+     {
+          return ( capacity + 63 ) / 64;
+     }
+}
+
+#endif
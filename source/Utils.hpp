@@ -50,7 +50,7 @@ struct FileContents {
      Void free ( GameMemory* game_memory );
 };
 
-// allocates bytes using game memory
+// allocates bytes in the frame arena of game memory
 extern "C" FileContents load_entire_file ( const Char8* filepath, GameMemory* game_memory );
 
 // does not work for negative reals
@@ -94,8 +94,15 @@ inline Bool point_inside_rect ( Real32 x, Real32 y, Real32 l, Real32 b, Real32 r
      return ( x >= l && x <= r && y >= b && y <= t );
 }
 
-Bool rect_collides_with_rect ( Real32 a_left, Real32 a_bottom, Real32 a_width, Real32 a_height,
-                               Real32 b_left, Real32 b_bottom, Real32 b_width, Real32 b_height );
+// separating axis test, rects overlap unless there is a gap between them on x or y. Touching
+// edges count as overlapping like they do for point_inside_rect ( )
+inline Bool rect_collides_with_rect ( Real32 a_left, Real32 a_bottom, Real32 a_width, Real32 a_height,
+                                      Real32 b_left, Real32 b_bottom, Real32 b_width, Real32 b_height )
+{
+     // & instead of && so there is nothing to branch on
+     return ( a_left <= b_left + b_width ) & ( b_left <= a_left + a_width ) &
+            ( a_bottom <= b_bottom + b_height ) & ( b_bottom <= a_bottom + a_height );
+}
 
 namespace bryte {
      class Random;